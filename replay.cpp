@@ -0,0 +1,193 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "tree-all.h"
+
+// Template definitions of the trees being replayed
+#include "tree.cpp"
+#include "trees/avl.cpp"
+
+// Replays a trace recorded with `Tree::TraceRecorder` against every backend,
+// reporting throughput and per-operation latency percentiles.
+//
+// Usage: tree_replay <trace file>
+
+namespace {
+
+using Key = uint64_t;
+using Value = uint64_t;
+
+// Capacity of the fixed-size trees, the trace shouldn't hold more keys at once.
+constexpr size_t Capacity = 1 << 20;
+
+
+// Backend adapters
+// They must implement `insert`, `get`, `set`, `remove` and `clear`.
+
+template<class TreeType>
+class TreeBackend {
+    // Too big for the stack
+    std::unique_ptr<TreeType> tree{new TreeType()};
+
+public:
+    // Doesn't throw on existing keys, like `MapBackend::insert`.
+    void insert(Key key) {
+        tree->insert(Tree::NodeHandle<Value, Key>(Key(key), Value(key)));
+    }
+    bool get(Key key, Value& value) {
+        return tree->try_get(key, value);
+    }
+    void set(Key key) {
+        tree->set(key, Value(key));
+    }
+    void remove(Key key) {
+        tree->remove(key);
+    }
+    void clear() {
+        tree->clear();
+    }
+};
+
+class MapBackend {
+    std::map<Key, Value> map;
+
+public:
+    void insert(Key key) {
+        if (map.size() < Capacity)
+            map.emplace(key, key);
+    }
+    bool get(Key key, Value& value) {
+        auto it = map.find(key);
+        if (it == map.end())
+            return false;
+        value = it->second;
+        return true;
+    }
+    void set(Key key) {
+        auto it = map.find(key);
+        if (it != map.end())
+            it->second = key;
+    }
+    void remove(Key key) {
+        map.erase(key);
+    }
+    void clear() {
+        map.clear();
+    }
+};
+
+
+template<class Backend>
+void apply(Backend& backend, const Tree::TraceEvent& event, Value& checksum) {
+    switch (event.op) {
+        case Tree::TraceOp::Insert:
+            backend.insert(event.key);
+            break;
+        case Tree::TraceOp::Get: {
+            Value value = 0;
+            if (backend.get(event.key, value))
+                checksum += value;
+            break;
+        }
+        case Tree::TraceOp::Set:
+            backend.set(event.key);
+            break;
+        case Tree::TraceOp::Remove:
+            backend.remove(event.key);
+            break;
+        case Tree::TraceOp::Clear:
+            backend.clear();
+            break;
+    }
+}
+
+template<class Backend>
+void replay(const std::string& name, const std::vector<Tree::TraceEvent>& events) {
+    using Clock = std::chrono::steady_clock;
+
+    // Keeps the lookups from being optimized out
+    Value checksum = 0;
+
+    // Throughput, without per-operation clocks
+    double seconds;
+    {
+        Backend backend;
+        auto start = Clock::now();
+        for (const auto& event : events)
+            apply(backend, event, checksum);
+        seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    }
+
+    // Latencies, on a fresh backend
+    std::vector<uint32_t> latencies(events.size());
+    {
+        Backend backend;
+        for (size_t i = 0; i < events.size(); i++) {
+            auto opStart = Clock::now();
+            apply(backend, events[i], checksum);
+            latencies[i] = static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                Clock::now() - opStart).count());
+        }
+    }
+
+    std::sort(latencies.begin(), latencies.end());
+    auto percentile = [&](double p) {
+        return latencies.empty() ? 0 : latencies[static_cast<size_t>(p * (latencies.size() - 1))];
+    };
+
+    std::cout << name << ": "
+        << static_cast<uint64_t>(events.size() / seconds) << " ops/s, "
+        << "p50 " << percentile(0.5) << " ns, "
+        << "p90 " << percentile(0.9) << " ns, "
+        << "p99 " << percentile(0.99) << " ns, "
+        << "p99.9 " << percentile(0.999) << " ns, "
+        << "max " << percentile(1.0) << " ns "
+        << "(checksum " << checksum << ")" << std::endl;
+}
+
+}  // namespace
+
+
+int main(int argc, char** argv) {
+    if (argc != 2) {
+        std::cerr << "Usage: " << argv[0] << " <trace file>" << std::endl;
+        return 1;
+    }
+
+    auto* file = std::fopen(argv[1], "rb");
+    if (file == nullptr) {
+        std::cerr << "Can't open " << argv[1] << std::endl;
+        return 1;
+    }
+
+    Tree::TraceReader reader(file);
+    if (!reader.is_valid()) {
+        std::cerr << argv[1] << " is not a trace file" << std::endl;
+        std::fclose(file);
+        return 1;
+    }
+
+    std::vector<Tree::TraceEvent> events;
+    Tree::TraceEvent event;
+    while (reader.next(event))
+        events.push_back(event);
+    std::fclose(file);
+
+    std::cout << "Replaying " << events.size() << " operations" << std::endl;
+
+    // RedBlackTree isn't implemented yet
+    replay<TreeBackend<Tree::AVLTree<Value, Key, Capacity>>>("AVLTree", events);
+    replay<TreeBackend<Tree::AVLTree<Value, Key, Capacity, Tree::SplitStorage>>>("AVLTree (SplitStorage)", events);
+    replay<TreeBackend<Tree::AVLTree<Value, Key, Capacity, Tree::PackedStorage, Tree::NoAugment, 1024>>>(
+        "AVLTree (1024 entry lookup cache)", events);
+    replay<MapBackend>("std::map", events);
+
+    return 0;
+}
@@ -0,0 +1,128 @@
+#include "check.h"
+
+#include <algorithm>
+#include <limits>
+#include <map>
+#include <memory>
+#include <random>
+#include <string>
+
+#include "tree-all.h"
+
+// Template definitions of the trees being tested
+#include "tree.cpp"
+#include "trees/avl.cpp"
+
+// `aggregate(lo, hi)` with sum, max and an order-sensitive monoid
+// against a `std::map` reference, through random inserts, removes and sets.
+
+namespace {
+
+constexpr size_t Capacity = 1024;
+
+// Concatenation of "key:value " in key order, not commutative.
+struct ConcatMonoid {
+    using Type = std::string;
+
+    static Type identity() {
+        return Type();
+    }
+    template<class K, class T>
+    static Type lift(const K& key, const T& value) {
+        return std::to_string(key) + ":" + std::to_string(value) + " ";
+    }
+    static Type combine(const Type& a, const Type& b) {
+        return a + b;
+    }
+};
+
+using Reference = std::map<int, int>;
+
+// Aggregate of the values of @p reference with keys in `[lo, hi)`.
+template<class Monoid>
+typename Monoid::Type scan(const Reference& reference, int lo, int hi) {
+    auto result = Monoid::identity();
+    for (auto it = reference.lower_bound(lo); it != reference.end() && it->first < hi; ++it)
+        result = Monoid::combine(result, Monoid::lift(it->first, it->second));
+    return result;
+}
+
+template<template<class, class, size_t> class Storage>
+void run(unsigned seed) {
+    using SumTree = Tree::AVLTree<int, int, Capacity, Storage, Tree::Aggregate<Tree::SumMonoid<int>>>;
+    using MaxTree = Tree::AVLTree<int, int, Capacity, Storage, Tree::Aggregate<Tree::MaxMonoid<int>>>;
+    using ConcatTree = Tree::AVLTree<int, int, Capacity, Storage, Tree::Aggregate<ConcatMonoid>>;
+
+    std::unique_ptr<SumTree> sum(new SumTree());
+    std::unique_ptr<MaxTree> max(new MaxTree());
+    std::unique_ptr<ConcatTree> concat(new ConcatTree());
+    Reference reference;
+    std::mt19937 random(seed);
+
+    const int lowest = std::numeric_limits<int>::min();
+    const int highest = std::numeric_limits<int>::max();
+
+    for (int i = 0; i < 3000; i++) {
+        int key = static_cast<int>(random() % 500);
+        int value = static_cast<int>(random() % 1000) - 500;
+
+        switch (random() % 3) {
+            case 0:
+                if (reference.count(key) == 0) {
+                    CHECK(sum->insert(int(key), int(value)));
+                    CHECK(max->insert(int(key), int(value)));
+                    CHECK(concat->insert(int(key), int(value)));
+                    reference[key] = value;
+                }
+                break;
+            case 1: {
+                bool exists = reference.erase(key) == 1;
+                CHECK(sum->remove(key) == exists);
+                CHECK(max->remove(key) == exists);
+                CHECK(concat->remove(key) == exists);
+                break;
+            }
+            case 2: {
+                bool exists = reference.count(key) == 1;
+                CHECK(sum->set(key, int(value)) == exists);
+                CHECK(max->set(key, int(value)) == exists);
+                CHECK(concat->set(key, int(value)) == exists);
+                if (exists)
+                    reference[key] = value;
+                break;
+            }
+        }
+
+        // Random range, possibly empty or reversed
+        int lo = static_cast<int>(random() % 520) - 10;
+        int hi = lo + static_cast<int>(random() % 200) - 20;
+        CHECK(sum->aggregate(lo, hi) == scan<Tree::SumMonoid<int>>(reference, lo, hi));
+        CHECK(max->aggregate(lo, hi) == scan<Tree::MaxMonoid<int>>(reference, lo, hi));
+        CHECK(concat->aggregate(lo, hi) == scan<ConcatMonoid>(reference, lo, hi));
+
+        // Open-ended ranges
+        CHECK(sum->aggregate(lowest, hi) == scan<Tree::SumMonoid<int>>(reference, lowest, hi));
+        CHECK(max->aggregate(lo, highest) == scan<Tree::MaxMonoid<int>>(reference, lo, highest));
+        CHECK(concat->aggregate(lowest, highest) == scan<ConcatMonoid>(reference, lowest, highest));
+    }
+
+    // Empty range and empty tree
+    CHECK(sum->aggregate(10, 10) == 0);
+    CHECK(concat->aggregate(10, 10).empty());
+    sum->clear();
+    max->clear();
+    CHECK(sum->aggregate(lowest, highest) == 0);
+    CHECK(max->aggregate(lowest, highest) == lowest);
+}
+
+}  // namespace
+
+
+int main() {
+    for (unsigned seed = 1; seed <= 3; seed++) {
+        run<Tree::PackedStorage>(seed);
+        run<Tree::SplitStorage>(seed);
+    }
+
+    return 0;
+}
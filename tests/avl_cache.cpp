@@ -0,0 +1,132 @@
+#include "check.h"
+
+#include <map>
+#include <memory>
+#include <random>
+
+#include "tree-all.h"
+
+// Template definitions of the trees being tested
+#include "tree.cpp"
+#include "trees/avl.cpp"
+
+// Lookup cache invalidation (remove, extract, slot reuse, clear)
+// and statistics, which only lookups count.
+
+namespace {
+
+constexpr size_t Capacity = 64;
+
+using CachedTree = Tree::AVLTree<int, int, Capacity, Tree::PackedStorage, Tree::NoAugment, 16>;
+
+void checkStats(const CachedTree& tree, size_t hits, size_t misses) {
+    CHECK(tree.cache_hits() == hits);
+    CHECK(tree.cache_misses() == misses);
+}
+
+}  // namespace
+
+
+int main() {
+    std::unique_ptr<CachedTree> tree(new CachedTree());
+    for (int key = 0; key < 32; key++)
+        CHECK(tree->insert(int(key), key * 10));
+    checkStats(*tree, 0, 0);
+
+    // Lookups fill the cache
+    CHECK(tree->contains_key(5));
+    checkStats(*tree, 0, 1);
+    CHECK(tree->get(5) == 50);
+    int value = 0;
+    CHECK(tree->try_get(5, value) && value == 50);
+    checkStats(*tree, 2, 1);
+
+    // Writes don't count
+    CHECK(tree->set(5, 51));
+    CHECK(tree->set(6, 61));
+    CHECK(!tree->remove(100));
+    CHECK(tree->extract(100).is_empty());
+    CHECK(tree->insert(40, 400));
+    checkStats(*tree, 2, 1);
+    CHECK(tree->get(5) == 51);
+    checkStats(*tree, 3, 1);
+
+    // Removed keys are forgotten
+    CHECK(tree->remove(5));
+    CHECK(!tree->contains_key(5));
+    checkStats(*tree, 3, 2);
+
+    // Extracted keys are forgotten
+    CHECK(tree->contains_key(9));
+    auto handle = tree->extract(9);
+    CHECK(!handle.is_empty() && handle.value() == 90);
+    CHECK(!tree->contains_key(9));
+
+    // Their slots are reused by other keys, then the keys come back elsewhere
+    CHECK(tree->contains_key(8));
+    CHECK(tree->remove(8));
+    CHECK(tree->insert(100, 1000));
+    CHECK(tree->insert(101, 1010));
+    CHECK(!tree->contains_key(8));
+    CHECK(tree->get(100) == 1000);
+    CHECK(tree->get(101) == 1010);
+    CHECK(tree->insert(8, 81));
+    CHECK(tree->insert(9, 91));
+    CHECK(tree->get(8) == 81);
+    CHECK(tree->get(9) == 91);
+
+    // Cleared trees forget everything
+    CHECK(tree->contains_key(10));
+    tree->clear();
+    for (int key = 0; key < 128; key++)
+        CHECK(!tree->contains_key(key));
+    CHECK(tree->insert(20, 200));
+    CHECK(tree->insert(10, 100));
+    CHECK(tree->get(10) == 100);
+    CHECK(tree->get(20) == 200);
+
+    tree->reset_cache_stats();
+    checkStats(*tree, 0, 0);
+
+    // Random operations against a `std::map`, lookups are the only ones counted
+    tree->clear();
+    std::map<int, int> expected;
+    std::mt19937 random(1);
+    size_t lookups = 0;
+    for (int i = 0; i < 20000; i++) {
+        // Few keys, so they collide in the cache
+        int key = static_cast<int>(random() % 96);
+
+        switch (random() % 6) {
+            case 0:
+                if (expected.count(key) == 0 && expected.size() < Capacity) {
+                    CHECK(tree->insert(int(key), int(i)));
+                    expected[key] = i;
+                }
+                break;
+            case 1:
+                CHECK(tree->remove(key) == (expected.erase(key) == 1));
+                break;
+            case 2:
+                CHECK(tree->extract(key).is_empty() == (expected.erase(key) == 0));
+                break;
+            case 3:
+                if (tree->set(key, int(i)))
+                    expected.at(key) = i;
+                else
+                    CHECK(expected.count(key) == 0);
+                break;
+            default: {
+                value = -1;
+                CHECK(tree->try_get(key, value) == (expected.count(key) == 1));
+                CHECK(expected.count(key) == 0 || value == expected[key]);
+                lookups++;
+                break;
+            }
+        }
+    }
+    CHECK(tree->cache_hits() + tree->cache_misses() == lookups);
+    CHECK(tree->cache_hits() > 0);
+
+    return 0;
+}
@@ -0,0 +1,158 @@
+#include "check.h"
+
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "tree-all.h"
+
+// Template definitions of the trees being tested
+#include "tree.cpp"
+#include "trees/avl.cpp"
+
+// AVL invariants (links, order, heights, balance) and the insertion finger
+// under sorted, near-sorted and mixed insert/remove streams, plain and hinted.
+
+namespace {
+
+using Tree::NoSlot;
+using Tree::Slot;
+
+constexpr size_t Capacity = 4096;
+
+// Exposes the internals of `AVLTree` to check its invariants.
+class CheckedTree : public Tree::AVLTree<int, int, Capacity> {
+    // Height of the subtree of `slot`, checking it on the way.
+    // Its keys must be in `(*lo, *hi)`, `nullptr` bounds are open.
+    int checkSubtree(Slot slot, Slot parent, const int* lo, const int* hi, size_t& nodeCount) const {
+        if (slot == NoSlot)
+            return 0;
+
+        const auto& n = node(slot);
+        CHECK(n.parent == parent);
+        CHECK(lo == nullptr || *lo < n.key);
+        CHECK(hi == nullptr || n.key < *hi);
+
+        auto left = checkSubtree(n.left, slot, lo, &n.key, nodeCount);
+        auto right = checkSubtree(n.right, slot, &n.key, hi, nodeCount);
+        CHECK(n.height == 1 + std::max(left, right));
+        CHECK(left - right <= 1 && right - left <= 1);
+
+        nodeCount++;
+        return n.height;
+    }
+
+public:
+    // Checks the invariants, the finger and the contents against @p expected.
+    void check(const std::map<int, int>& expected) const {
+        size_t nodeCount = 0;
+        checkSubtree(root, NoSlot, nullptr, nullptr, nodeCount);
+        CHECK(nodeCount == count);
+        CHECK(count == expected.size());
+
+        // Contents in key order, and the finger's neighbours on the way
+        Slot previous = NoSlot;
+        bool fingerSeen = false;
+        auto slot = first();
+        for (const auto& entry : expected) {
+            CHECK(slot != NoSlot);
+            CHECK(node(slot).key == entry.first);
+            CHECK(nodes.value(slot) == entry.second);
+
+            if (slot == finger) {
+                fingerSeen = true;
+                CHECK(fingerPred == previous);
+                CHECK(fingerSucc == next(slot));
+            }
+
+            previous = slot;
+            slot = next(slot);
+        }
+        CHECK(slot == NoSlot);
+        CHECK(finger == NoSlot || fingerSeen);
+    }
+};
+
+
+// Inserts @p keys in order, plainly or chaining hints, checking after each one.
+void insertAll(const std::vector<int>& keys, bool hinted) {
+    std::unique_ptr<CheckedTree> tree(new CheckedTree());
+    std::map<int, int> expected;
+
+    CheckedTree::Position hint;
+    for (auto key : keys) {
+        if (hinted) {
+            hint = tree->insert_hint(hint, int(key), int(key * 3));
+            CHECK(hint.slot != NoSlot);
+        } else {
+            CHECK(tree->insert(int(key), int(key * 3)));
+        }
+        expected[key] = key * 3;
+
+        tree->check(expected);
+    }
+}
+
+// Random inserts (plain and hinted), removes and extracts, checking after each one.
+void mixed(unsigned seed) {
+    std::unique_ptr<CheckedTree> tree(new CheckedTree());
+    std::map<int, int> expected;
+    std::mt19937 random(seed);
+
+    CheckedTree::Position hint;
+    for (int i = 0; i < 4000; i++) {
+        int key = static_cast<int>(random() % 1024);
+        auto op = random() % 4;
+
+        if (op == 0 && expected.count(key) == 0) {
+            CHECK(tree->insert(int(key), int(i)));
+            expected[key] = i;
+        } else if (op == 1 && expected.count(key) == 0) {
+            hint = tree->insert_hint(hint, int(key), int(i));
+            expected[key] = i;
+        } else if (op == 2) {
+            CHECK(tree->remove(key) == (expected.erase(key) == 1));
+        } else if (op == 3) {
+            auto handle = tree->extract(key);
+            CHECK(handle.is_empty() == (expected.erase(key) == 0));
+        }
+
+        tree->check(expected);
+    }
+}
+
+}  // namespace
+
+
+int main() {
+    const int count = 1000;
+    std::mt19937 random(1);
+
+    std::vector<int> ascending(count);
+    for (int i = 0; i < count; i++)
+        ascending[i] = i;
+
+    std::vector<int> descending(ascending.rbegin(), ascending.rend());
+
+    // Sorted, with keys swapped within small windows
+    auto nearSorted = ascending;
+    for (int i = 0; i + 8 < count; i += 4)
+        std::swap(nearSorted[i + random() % 8], nearSorted[i + random() % 8]);
+
+    auto shuffled = ascending;
+    std::shuffle(shuffled.begin(), shuffled.end(), random);
+
+    for (auto hinted : {false, true}) {
+        insertAll(ascending, hinted);
+        insertAll(descending, hinted);
+        insertAll(nearSorted, hinted);
+        insertAll(shuffled, hinted);
+    }
+
+    for (unsigned seed = 1; seed <= 4; seed++)
+        mixed(seed);
+
+    return 0;
+}
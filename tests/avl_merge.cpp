@@ -0,0 +1,118 @@
+#include "check.h"
+
+#include <memory>
+
+#include "tree-all.h"
+
+// Template definitions of the trees being tested
+#include "tree.cpp"
+#include "trees/avl.cpp"
+
+// `merge` across sizes, storages and augmentations: full targets,
+// conflicting keys (which stay in the source) and self-merge.
+
+namespace {
+
+using Small = Tree::AVLTree<int, int, 64>;
+using Big = Tree::AVLTree<int, int, 256, Tree::SplitStorage>;
+using Summed = Tree::AVLTree<int, int, 256, Tree::PackedStorage, Tree::Aggregate<Tree::SumMonoid<int>>>;
+
+// Source keys are 0..99 with value `2 * key`,
+// target keys are multiples of 10 below 200 with value `3 * key`.
+template<class TreeType>
+void fillSource(TreeType& tree) {
+    for (int key = 0; key < 100; key++)
+        CHECK(tree.insert(int(key), 2 * key));
+}
+template<class TreeType>
+void fillTarget(TreeType& tree) {
+    for (int key = 0; key < 200; key += 10)
+        CHECK(tree.insert(int(key), 3 * key));
+}
+
+// Each source key is in the target or still in the source, with its value,
+// conflicting keys are in both with their own values.
+template<class Target, class Source>
+void checkMerged(const Target& target, const Source& source) {
+    for (int key = 0; key < 100; key++) {
+        if (key % 10 == 0) {
+            CHECK(target.get(key) == 3 * key);
+            CHECK(source.get(key) == 2 * key);
+        } else {
+            CHECK(target.contains_key(key) != source.contains_key(key));
+            CHECK((target.contains_key(key) ? target.get(key) : source.get(key)) == 2 * key);
+        }
+    }
+    for (int key = 100; key < 200; key += 10)
+        CHECK(target.get(key) == 3 * key);
+}
+
+}  // namespace
+
+
+int main() {
+    // Room for everything: only the conflicting keys stay in the source
+    {
+        std::unique_ptr<Big> target(new Big());
+        std::unique_ptr<Small> source(new Small());
+        fillTarget(*target);
+        for (int key = 0; key < 60; key++)
+            CHECK(source->insert(int(key), 2 * key));
+
+        CHECK(target->merge(*source) == 54);
+        CHECK(target->size() == 20 + 54);
+        CHECK(source->size() == 6);
+        for (int key = 0; key < 60; key++) {
+            CHECK(target->contains_key(key));
+            CHECK(source->contains_key(key) == (key % 10 == 0));
+        }
+    }
+
+    // Stops when the target is full
+    {
+        std::unique_ptr<Small> target(new Small());
+        std::unique_ptr<Big> source(new Big());
+        fillTarget(*target);
+        fillSource(*source);
+
+        CHECK(target->merge(*source) == 64 - 20);
+        CHECK(target->is_full());
+        CHECK(source->size() == 100 - 44);
+        checkMerged(*target, *source);
+
+        // Nothing more fits
+        CHECK(target->merge(*source) == 0);
+        CHECK(source->size() == 100 - 44);
+    }
+
+    // Into an augmented tree, its aggregates follow
+    {
+        std::unique_ptr<Summed> target(new Summed());
+        std::unique_ptr<Big> source(new Big());
+        fillTarget(*target);
+        fillSource(*source);
+
+        CHECK(target->merge(*source) == 90);
+        CHECK(source->size() == 10);
+        checkMerged(*target, *source);
+
+        int expected = 0;
+        for (int key = 0; key < 200; key++)
+            if (target->contains_key(key))
+                expected += target->get(key);
+        CHECK(target->aggregate(0, 200) == expected);
+    }
+
+    // Self-merge does nothing
+    {
+        std::unique_ptr<Big> tree(new Big());
+        fillSource(*tree);
+
+        CHECK(tree->merge(*tree) == 0);
+        CHECK(tree->size() == 100);
+        for (int key = 0; key < 100; key++)
+            CHECK(tree->get(key) == 2 * key);
+    }
+
+    return 0;
+}
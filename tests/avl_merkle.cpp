@@ -0,0 +1,170 @@
+#include "check.h"
+
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <random>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "tree-all.h"
+
+// Template definitions of the trees being tested
+#include "tree.cpp"
+#include "trees/avl.cpp"
+
+// `MerkleHash` equality and diff of trees with the same contents
+// built in different orders, against a `std::map` reference.
+
+namespace {
+
+constexpr size_t Capacity = 4096;
+
+using HashedTree = Tree::AVLTree<std::string, int, Capacity, Tree::SplitStorage, Tree::MerkleHash>;
+using Reference = std::map<int, std::string>;
+
+// Root hash can be overwritten, to simulate a collision.
+class ForgeableTree : public HashedTree {
+public:
+    void forge_hash(const ForgeableTree& other) {
+        node(root).aggregate = other.node(other.root).aggregate;
+    }
+};
+
+// Key, value in the first tree and value in the second, "-" if missing.
+using Difference = std::tuple<int, std::string, std::string>;
+
+void insertAll(HashedTree& tree, const Reference& reference, std::vector<int> order) {
+    for (auto key : order)
+        CHECK(tree.insert(int(key), std::string(reference.at(key))));
+}
+
+std::vector<Difference> diff(const HashedTree& a, const HashedTree& b) {
+    std::vector<Difference> differences;
+    a.diff(b, [&](const int& key, const std::string* value, const std::string* otherValue) {
+        differences.emplace_back(key, value ? *value : "-", otherValue ? *otherValue : "-");
+    });
+    return differences;
+}
+
+std::vector<Difference> diff(const Reference& a, const Reference& b) {
+    std::vector<Difference> differences;
+    auto itA = a.begin();
+    auto itB = b.begin();
+    while (itA != a.end() || itB != b.end()) {
+        if (itB == b.end() || (itA != a.end() && itA->first < itB->first)) {
+            differences.emplace_back(itA->first, itA->second, "-");
+            ++itA;
+        } else if (itA == a.end() || itB->first < itA->first) {
+            differences.emplace_back(itB->first, "-", itB->second);
+            ++itB;
+        } else {
+            if (itA->second != itB->second)
+                differences.emplace_back(itA->first, itA->second, itB->second);
+            ++itA;
+            ++itB;
+        }
+    }
+    return differences;
+}
+
+}  // namespace
+
+
+int main() {
+    std::mt19937 random(1);
+
+    Reference reference;
+    std::vector<int> keys;
+    for (int i = 0; i < 2000; i++) {
+        keys.push_back(i * 2);
+        reference[i * 2] = std::to_string(i);
+    }
+
+    // Same contents, different insert orders, so different shapes
+    std::unique_ptr<HashedTree> a(new HashedTree());
+    std::unique_ptr<HashedTree> b(new HashedTree());
+    auto shuffled = keys;
+    std::shuffle(shuffled.begin(), shuffled.end(), random);
+    insertAll(*a, reference, keys);
+    insertAll(*b, reference, shuffled);
+
+    CHECK(*a == *b);
+    CHECK(diff(*a, *b).empty());
+
+    // Change values, remove and add keys in `b`
+    auto changed = reference;
+    for (int i = 0; i < 40; i++) {
+        auto key = keys[random() % keys.size()];
+        switch (random() % 3) {
+            case 0:
+                if (b->set(key, "changed " + std::to_string(i)))
+                    changed[key] = "changed " + std::to_string(i);
+                break;
+            case 1:
+                b->remove(key);
+                changed.erase(key);
+                break;
+            case 2:
+                if (!b->contains_key(key + 1)) {
+                    CHECK(b->insert(key + 1, "added"));
+                    changed[key + 1] = "added";
+                }
+                break;
+        }
+    }
+
+    CHECK(!(*a == *b));
+    CHECK(*a != *b);
+    auto expected = diff(reference, changed);
+    CHECK(!expected.empty());
+    CHECK(diff(*a, *b) == expected);
+    CHECK(diff(*b, *a) == diff(changed, reference));
+
+    // Undo the changes, equal again
+    for (const auto& difference : expected) {
+        auto key = std::get<0>(difference);
+        if (std::get<1>(difference) == "-")
+            b->remove(key);
+        else if (std::get<2>(difference) == "-")
+            CHECK(b->insert(int(key), std::string(std::get<1>(difference))));
+        else
+            CHECK(b->set(key, std::string(std::get<1>(difference))));
+    }
+
+    CHECK(*a == *b);
+    CHECK(diff(*a, *b).empty());
+
+    // Same count, different contents
+    CHECK(b->set(0, "other"));
+    CHECK(a->size() == b->size());
+    CHECK(*a != *b);
+    CHECK(!a->probably_equal(*b));
+    CHECK(b->set(0, std::string(reference.at(0))));
+    CHECK(a->probably_equal(*b));
+
+    // Equal hashes don't make different trees equal
+    {
+        std::unique_ptr<ForgeableTree> c(new ForgeableTree());
+        std::unique_ptr<ForgeableTree> d(new ForgeableTree());
+        insertAll(*c, reference, keys);
+        insertAll(*d, reference, shuffled);
+        CHECK(d->remove(2));
+        CHECK(d->insert(3, "3"));
+
+        d->forge_hash(*c);
+        CHECK(c->probably_equal(*d));
+        CHECK(!(*c == *d));
+        CHECK(*c != *d);
+    }
+
+    // Empty trees
+    std::unique_ptr<HashedTree> empty(new HashedTree());
+    std::unique_ptr<HashedTree> otherEmpty(new HashedTree());
+    CHECK(*empty == *otherEmpty);
+    CHECK(diff(*empty, *otherEmpty).empty());
+    CHECK(diff(*empty, *a).size() == reference.size());
+
+    return 0;
+}
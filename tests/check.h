@@ -0,0 +1,17 @@
+#ifndef TREE_TESTS_CHECK_H
+#define TREE_TESTS_CHECK_H
+
+#include <cstdio>
+#include <cstdlib>
+
+// Fails the test with the location of `condition` if it's false.
+// Unlike `assert`, also checked in release builds.
+#define CHECK(condition) \
+    do { \
+        if (!(condition)) { \
+            std::fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #condition); \
+            std::exit(1); \
+        } \
+    } while (false)
+
+#endif // TREE_TESTS_CHECK_H
@@ -0,0 +1,99 @@
+#include "check.h"
+
+#include <map>
+#include <memory>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include "tree-all.h"
+
+// Template definitions of the trees being tested
+#include "tree.cpp"
+#include "trees/avl.cpp"
+
+// Overlap and stabbing queries against a brute-force scan,
+// through random inserts and removes (which rotate and update `maxHi`).
+
+namespace {
+
+constexpr size_t Capacity = 1024;
+
+using IntervalTree = Tree::IntervalTree<int, int, Capacity>;
+using Interval = Tree::Interval<int>;
+using Reference = std::map<Interval, int>;
+using Results = std::vector<std::pair<Interval, int>>;
+
+Results overlapping(const IntervalTree& tree, int lo, int hi) {
+    Results results;
+    tree.find_overlapping(lo, hi, [&](const Interval& interval, const int& value) {
+        results.emplace_back(interval, value);
+    });
+    return results;
+}
+
+Results stabbed(const IntervalTree& tree, int point) {
+    Results results;
+    tree.stab(point, [&](const Interval& interval, const int& value) {
+        results.emplace_back(interval, value);
+    });
+    return results;
+}
+
+// Intervals of @p reference intersecting `[lo, hi]`, in key order.
+Results scan(const Reference& reference, int lo, int hi) {
+    Results results;
+    for (const auto& entry : reference)
+        if (!(entry.first.hi < lo) && !(hi < entry.first.lo))
+            results.emplace_back(entry.first, entry.second);
+    return results;
+}
+
+}  // namespace
+
+
+int main() {
+    std::mt19937 random(1);
+    std::unique_ptr<IntervalTree> tree(new IntervalTree());
+    Reference reference;
+
+    for (int i = 0; i < 6000; i++) {
+        // Mostly short intervals, a few long ones
+        int lo = static_cast<int>(random() % 1000);
+        int length = random() % 8 == 0 ? static_cast<int>(random() % 400) : static_cast<int>(random() % 20);
+        Interval interval{lo, lo + length};
+
+        if (random() % 3 != 0 && reference.size() < Capacity) {
+            if (reference.count(interval) == 0) {
+                CHECK(tree->insert(Interval(interval), int(i)));
+                reference[interval] = i;
+            }
+        } else {
+            // Remove a stored interval, or a missing one
+            if (!reference.empty() && random() % 4 != 0) {
+                auto it = reference.begin();
+                std::advance(it, random() % reference.size());
+                interval = it->first;
+            }
+            CHECK(tree->remove(interval) == (reference.erase(interval) == 1));
+        }
+
+        if (i % 10 != 0)
+            continue;
+
+        int queryLo = static_cast<int>(random() % 1500) - 100;
+        int queryHi = queryLo + static_cast<int>(random() % 50);
+        CHECK(overlapping(*tree, queryLo, queryHi) == scan(reference, queryLo, queryHi));
+        CHECK(stabbed(*tree, queryLo) == scan(reference, queryLo, queryLo));
+    }
+
+    CHECK(tree->size() == reference.size());
+
+    // Whole range and empty tree
+    CHECK(overlapping(*tree, -1000, 3000) == scan(reference, -1000, 3000));
+    tree->clear();
+    CHECK(overlapping(*tree, -1000, 3000).empty());
+    CHECK(stabbed(*tree, 10).empty());
+
+    return 0;
+}
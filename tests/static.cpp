@@ -0,0 +1,136 @@
+#include "check.h"
+
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+#include "trees/static.h"
+
+// `StaticTree` lookups at compile time, and iteration at run time, for sizes
+// around powers of two (full, one short of and one past a full Eytzinger layout).
+
+namespace {
+
+template<size_t Size>
+using IntTree = Tree::StaticTree<int, int, Size>;
+
+// Keys `3 * i` in a scrambled order, values `2 * key`.
+template<size_t Size>
+constexpr IntTree<Size> makeTree() {
+    Tree::StaticEntry<int, int> entries[Size]{};
+    for (size_t i = 0; i < Size; i++) {
+        int key = static_cast<int>((i * 13) % Size) * 3;
+        entries[i] = {key, key * 2};
+    }
+    return IntTree<Size>(entries);
+}
+
+// Every key is found with its value, keys in between aren't,
+// and iteration visits them all in order.
+template<size_t Size>
+constexpr bool isValid(const IntTree<Size>& tree) {
+    for (size_t i = 0; i < Size; i++) {
+        int key = static_cast<int>(i) * 3;
+        int value = 0;
+        if (!tree.contains_key(key) || tree.get(key) != key * 2 || tree[key] != key * 2)
+            return false;
+        if (!tree.try_get(key, value) || value != key * 2)
+            return false;
+        if (tree.contains_key(key + 1) || tree.try_get(key - 1, value))
+            return false;
+    }
+
+    size_t count = 0;
+    for (auto it = tree.begin(); it != tree.end(); ++it, count++)
+        if (it.key() != static_cast<int>(count) * 3 || it.value() != it.key() * 2)
+            return false;
+    return count == Size;
+}
+
+constexpr auto tree1 = makeTree<1>();
+constexpr auto tree7 = makeTree<7>();
+constexpr auto tree8 = makeTree<8>();
+constexpr auto tree9 = makeTree<9>();
+constexpr auto tree15 = makeTree<15>();
+constexpr auto tree16 = makeTree<16>();
+constexpr auto tree17 = makeTree<17>();
+constexpr auto tree31 = makeTree<31>();
+constexpr auto tree32 = makeTree<32>();
+constexpr auto tree33 = makeTree<33>();
+
+static_assert(isValid(tree1), "");
+static_assert(isValid(tree7), "");
+static_assert(isValid(tree8), "");
+static_assert(isValid(tree9), "");
+static_assert(isValid(tree15), "");
+static_assert(isValid(tree16), "");
+static_assert(isValid(tree17), "");
+static_assert(isValid(tree31), "");
+static_assert(isValid(tree32), "");
+static_assert(isValid(tree33), "");
+
+static_assert(tree9.get(24) == 48, "");
+static_assert(tree9.contains_key(0) && !tree9.contains_key(27), "");
+
+constexpr auto codes = Tree::make_static_tree<const char*, int>({
+    {404, "Not Found"}, {200, "OK"}, {500, "Internal Server Error"}, {301, "Moved Permanently"},
+});
+static_assert(codes.size() == 4, "");
+static_assert(codes.get(200)[0] == 'O', "");
+static_assert(!codes.contains_key(302), "");
+
+// Runtime iteration is in key order.
+template<size_t Size>
+void checkSorted(const IntTree<Size>& tree) {
+    size_t count = 0;
+    int previous = -1;
+    for (const auto& entry : tree) {
+        CHECK(previous < entry.key());
+        previous = entry.key();
+        count++;
+    }
+    CHECK(count == Size);
+}
+
+}  // namespace
+
+
+int main() {
+    checkSorted(tree1);
+    checkSorted(tree7);
+    checkSorted(tree8);
+    checkSorted(tree9);
+    checkSorted(tree15);
+    checkSorted(tree16);
+    checkSorted(tree17);
+    checkSorted(tree31);
+    checkSorted(tree32);
+    checkSorted(tree33);
+
+    CHECK(std::strcmp(codes[404], "Not Found") == 0);
+
+    // Built at run time, with non-literal values
+    Tree::StaticTree<std::string, int, 5> names({{3, "c"}, {1, "a"}, {5, "e"}, {2, "b"}, {4, "d"}});
+    std::string all;
+    for (const auto& entry : names)
+        all += entry.value();
+    CHECK(all == "abcde");
+
+    bool thrown = false;
+    try {
+        names.get(6);
+    } catch (const std::out_of_range&) {
+        thrown = true;
+    }
+    CHECK(thrown);
+
+    thrown = false;
+    try {
+        Tree::StaticTree<int, int, 2> duplicates({{1, 1}, {1, 2}});
+    } catch (const std::invalid_argument&) {
+        thrown = true;
+    }
+    CHECK(thrown);
+
+    return 0;
+}
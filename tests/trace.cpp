@@ -0,0 +1,150 @@
+#include "check.h"
+
+#include <cstdio>
+#include <memory>
+#include <vector>
+
+#include "tree-all.h"
+
+// Template definitions of the trees being tested
+#include "tree.cpp"
+#include "trees/avl.cpp"
+
+// `TraceRecorder` ring buffer and file flushes, read back with `TraceReader`.
+
+namespace {
+
+using Tree::TraceEvent;
+using Tree::TraceOp;
+using Tree::TraceRecorder;
+
+// Event number @p i of the recorded streams.
+TraceEvent event(size_t i) {
+    return TraceEvent{static_cast<TraceOp>(i % 5), i * 0x9e3779b97f4a7c15ull};
+}
+
+bool operator==(const TraceEvent& a, const TraceEvent& b) {
+    return a.op == b.op && a.key == b.key;
+}
+
+long fileSize(std::FILE* file) {
+    std::fseek(file, 0, SEEK_END);
+    return std::ftell(file);
+}
+
+// Reads all the events of @p file, from its start.
+std::vector<TraceEvent> readAll(std::FILE* file) {
+    std::rewind(file);
+    Tree::TraceReader reader(file);
+    CHECK(reader.is_valid());
+
+    std::vector<TraceEvent> events;
+    TraceEvent read;
+    while (reader.next(read))
+        events.push_back(read);
+    return events;
+}
+
+// Header: magic and version, events: op and key.
+constexpr long HeaderBytes = 5;
+constexpr long EventBytes = 9;
+
+}  // namespace
+
+
+int main() {
+    const auto bufferSize = TraceRecorder::BufferSize;
+
+    // Without a file, only the last `BufferSize` events are kept
+    {
+        std::unique_ptr<TraceRecorder> recorder(new TraceRecorder());
+        for (size_t i = 0; i < bufferSize + 5; i++)
+            recorder->record(event(i).op, event(i).key);
+
+        CHECK(recorder->recorded() == bufferSize + 5);
+        CHECK(recorder->size() == bufferSize);
+        CHECK((*recorder)[0] == event(5));
+        CHECK((*recorder)[bufferSize - 1] == event(bufferSize + 4));
+    }
+
+    // A `nullptr` file is no file
+    {
+        std::unique_ptr<TraceRecorder> recorder(new TraceRecorder(nullptr));
+        recorder->record(TraceOp::Get, 1);
+        recorder->flush();
+        CHECK(recorder->size() == 1);
+    }
+
+    // Written out when the buffer fills up, the rest by the destructor
+    {
+        auto* file = std::tmpfile();
+        CHECK(file != nullptr);
+
+        const size_t count = 2 * bufferSize + 17;
+        {
+            std::unique_ptr<TraceRecorder> recorder(new TraceRecorder(file));
+            for (size_t i = 0; i < count; i++) {
+                recorder->record(event(i).op, event(i).key);
+
+                // Nothing but the header until the buffer is full
+                if (i + 2 == bufferSize)
+                    CHECK(fileSize(file) == HeaderBytes);
+                if (i + 1 == bufferSize)
+                    CHECK(fileSize(file) == HeaderBytes + EventBytes * static_cast<long>(bufferSize));
+            }
+            CHECK(fileSize(file) == HeaderBytes + EventBytes * static_cast<long>(2 * bufferSize));
+        }
+        CHECK(fileSize(file) == HeaderBytes + EventBytes * static_cast<long>(count));
+
+        auto events = readAll(file);
+        CHECK(events.size() == count);
+        for (size_t i = 0; i < count; i++)
+            CHECK(events[i] == event(i));
+
+        std::fclose(file);
+    }
+
+    // Tree operations
+    {
+        auto* file = std::tmpfile();
+        CHECK(file != nullptr);
+        {
+            TraceRecorder recorder(file);
+            std::unique_ptr<Tree::AVLTree<int, int, 16>> tree(new Tree::AVLTree<int, int, 16>());
+            tree->set_recorder(&recorder);
+
+            CHECK(tree->insert(7, 70));
+            CHECK(tree->contains_key(7));
+            CHECK(tree->set(7, 71));
+            CHECK(tree->remove(7));
+            tree->clear();
+        }
+
+        auto events = readAll(file);
+        std::vector<TraceEvent> expected = {
+            {TraceOp::Insert, 7},
+            {TraceOp::Get, 7},
+            {TraceOp::Set, 7},
+            {TraceOp::Remove, 7},
+            {TraceOp::Clear, 0},
+        };
+        CHECK(events.size() == expected.size());
+        for (size_t i = 0; i < expected.size(); i++)
+            CHECK(events[i] == expected[i]);
+
+        std::fclose(file);
+    }
+
+    // Not a trace file
+    {
+        auto* file = std::tmpfile();
+        CHECK(file != nullptr);
+        std::fputs("BSTX", file);
+        std::rewind(file);
+        CHECK(!Tree::TraceReader(file).is_valid());
+
+        std::fclose(file);
+    }
+
+    return 0;
+}
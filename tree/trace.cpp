@@ -0,0 +1,76 @@
+#include "trace.h"
+
+
+namespace Tree {
+
+namespace {
+
+constexpr char Magic[4] = {'B', 'S', 'T', 'T'};
+constexpr uint8_t Version = 1;
+constexpr size_t EventBytes = 9;
+
+}  // namespace
+
+
+constexpr size_t TraceRecorder::BufferSize;
+
+TraceRecorder::TraceRecorder(std::FILE* file) : file(file) {
+    if (file == nullptr)
+        return;
+
+    std::fwrite(Magic, 1, sizeof(Magic), file);
+    std::fputc(Version, file);
+}
+
+TraceRecorder::~TraceRecorder() {
+    flush();
+}
+
+void TraceRecorder::flush() {
+    if (file == nullptr)
+        return;
+
+    // Events that didn't fit in the buffer are lost
+    if (head - flushed > BufferSize)
+        flushed = head - BufferSize;
+
+    std::array<uint8_t, EventBytes> bytes;
+    for (; flushed < head; flushed++) {
+        const auto& event = buffer[flushed % BufferSize];
+        bytes[0] = static_cast<uint8_t>(event.op);
+        for (size_t i = 0; i < 8; i++)
+            bytes[i + 1] = static_cast<uint8_t>(event.key >> (i * 8));
+        std::fwrite(bytes.data(), 1, bytes.size(), file);
+    }
+    std::fflush(file);
+}
+
+
+TraceReader::TraceReader(std::FILE* file) : file(file) {
+    char magic[sizeof(Magic)];
+    if (std::fread(magic, 1, sizeof(magic), file) != sizeof(magic))
+        return;
+
+    for (size_t i = 0; i < sizeof(Magic); i++)
+        if (magic[i] != Magic[i])
+            return;
+
+    valid = std::fgetc(file) == Version;
+}
+
+bool TraceReader::next(TraceEvent& event) {
+    if (!valid)
+        return false;
+
+    std::array<uint8_t, EventBytes> bytes;
+    if (std::fread(bytes.data(), 1, bytes.size(), file) != bytes.size())
+        return false;
+
+    event.op = static_cast<TraceOp>(bytes[0]);
+    event.key = 0;
+    for (size_t i = 0; i < 8; i++)
+        event.key |= static_cast<uint64_t>(bytes[i + 1]) << (i * 8);
+    return true;
+}
+
+}  // namespace Tree
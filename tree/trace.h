@@ -0,0 +1,159 @@
+#ifndef TREE_TRACE_H
+#define TREE_TRACE_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <type_traits>
+#include <utility>
+
+
+namespace Tree {
+
+// Traced operations, see `Tree::set_recorder`.
+enum class TraceOp : uint8_t {
+    Insert = 0,
+    Get = 1,
+    Set = 2,
+    Remove = 3,
+    Clear = 4,
+};
+
+struct TraceEvent {
+    TraceOp op;
+    // Raw key for integral and enum keys, `std::hash` of the key otherwise.
+    uint64_t key;
+};
+
+
+// Trace key of keys with `std::hash`: their hash.
+template<class K>
+auto hashTraceKey(const K& key, int) -> decltype(std::hash<K>{}(key), uint64_t()) {
+    return std::hash<K>{}(key);
+}
+// Keys without `std::hash` can't be traced, `Tree::set_recorder` doesn't compile for them.
+// This only lets `Tree::record` compile, it's never called with a recorder.
+template<class K>
+uint64_t hashTraceKey(const K&, long) {
+    return 0;
+}
+
+// Whether keys of type `K` can be traced: integral, enum or with `std::hash`.
+template<class K>
+struct IsTraceable {
+private:
+    template<class U>
+    static auto test(int) -> decltype(std::hash<U>{}(std::declval<const U&>()), std::true_type());
+    template<class U>
+    static std::false_type test(long);
+
+public:
+    static constexpr bool value = std::is_integral<K>::value || std::is_enum<K>::value
+        || decltype(test<K>(0))::value;
+};
+
+// Trace key of integral and enum keys: the key itself.
+template<class K>
+uint64_t traceKey(const K& key, std::true_type) {
+    return static_cast<uint64_t>(key);
+}
+template<class K>
+uint64_t traceKey(const K& key, std::false_type) {
+    return hashTraceKey(key, 0);
+}
+template<class K>
+uint64_t traceKey(const K& key) {
+    return traceKey(key, std::integral_constant<bool,
+        std::is_integral<K>::value || std::is_enum<K>::value>{});
+}
+
+
+// Operation trace recorder
+//
+// Records the operations of the tree it's attached to into a ring buffer.
+// Events don't say which tree they come from: attach a recorder to one tree at a time,
+// the interleaved operations of several trees can't be replayed.
+// Without a file only the last `BufferSize` events are kept.
+// With a file the buffer is written out every time it fills up (and on `flush`).
+//
+// File format (little endian):
+// - Header: "BSTT" magic, version byte (1).
+// - Events: op byte, 8 bytes of key.
+class TraceRecorder {
+public:
+    static constexpr size_t BufferSize = 4096;
+
+    // Constructors
+    TraceRecorder() = default;
+    /// @p file is written to, not closed. Writes the header.
+    ///   `nullptr` means no file, like the default constructor.
+    explicit TraceRecorder(std::FILE* file);
+
+    TraceRecorder(const TraceRecorder& other) = delete;
+    TraceRecorder& operator=(const TraceRecorder& other) = delete;
+
+    // Destructor
+    // Flushes the buffer to the file.
+    ~TraceRecorder();
+
+    void record(TraceOp op, uint64_t key) {
+        buffer[head % BufferSize] = TraceEvent{op, key};
+        head++;
+
+        if (file != nullptr && head - flushed == BufferSize)
+            flush();
+    }
+
+    // Write the events not yet written to the file.
+    void flush();
+
+    // Count of events recorded since creation.
+    size_t recorded() const {
+        return head;
+    }
+
+    // Count of events in the buffer.
+    size_t size() const {
+        return head < BufferSize ? head : BufferSize;
+    }
+
+    // Buffered event, 0 is the oldest.
+    const TraceEvent& operator[](size_t index) const {
+        return buffer[(head - size() + index) % BufferSize];
+    }
+
+private:
+    std::array<TraceEvent, BufferSize> buffer{};
+    // Count of events recorded.
+    size_t head = 0;
+    // Count of events written to the file.
+    size_t flushed = 0;
+
+    std::FILE* file = nullptr;
+};
+
+
+// Reads trace files written by `TraceRecorder`.
+class TraceReader {
+public:
+    /// @p file is read from, not closed. Reads the header.
+    explicit TraceReader(std::FILE* file);
+
+    // Whether the header was valid.
+    bool is_valid() const {
+        return valid;
+    }
+
+    /// @returns true if an event was read, false at the end of the trace.
+    bool next(TraceEvent& event);
+
+private:
+    std::FILE* file;
+    bool valid = false;
+};
+
+}  // namespace Tree
+
+#endif // TREE_TRACE_H
@@ -4,6 +4,8 @@
 #include "tree.h"
 
 #include "trees/avl.h"
+#include "trees/interval.h"
+#include "trees/static.h"
 // #include "trees/redblack.h"
 
 #endif // TREE_ALL_H
@@ -1,8 +1,11 @@
 #ifndef TREE_H
 #define TREE_H
 
+#include "trace.h"
+
 #include <cstddef>
 #include <cstdint>
+#include <type_traits>
 #include <utility>
 
 namespace Tree {
@@ -14,54 +17,63 @@ namespace Tree {
     // };
 
 
-    // Node interface
+    // Nodes
     //
-    // Implementations should inherit from this class.
-    // They must implement the following functions:
-    // - Default constructor. `Tree`s may allocate `std::array`s of nodes on creation.
-    // - Move assignment operator.
-    // - `K& _key()`
-    // - `const K& _key() const`
-    // - `T& _value()`
-    // - `const T& _value() const`
-    template <class T, class K, class NodeType>
-    struct Node {
-        using ValueType = T;
-        using KeyType = K;
+    // There's no common node type: each tree defines its own "hot" node
+    // (key, slot links and balance info, e.g. `AVLNode`) and keeps its nodes and values
+    // in a storage policy, see `trees/generic/storage.h`.
 
-        // Require the derived implementation NodeType have a default constructor. (not sure it actually does)
-        Node() = default;
 
-        // Move constructor
-        Node(Node&& other) {
-            static_cast<NodeType*>(this)->operator=(std::move(static_cast<NodeType&>(other)));
-        }
+    // Node handle
+    // Owns a key and a value taken out of a tree with `extract`,
+    // to be `insert`ed into another tree of the same `K` and `T`.
+    // The trees' node pools are fixed arrays, so the handle holds the key and value themselves.
+    template <class T, class K>
+    class NodeHandle {
+        K heldKey{};
+        T heldValue{};
+        bool empty = true;
 
-        // Move assignment operator
-        Node& operator=(Node&& other) {
-            static_cast<NodeType*>(this)->operator=(std::move(static_cast<NodeType&>(other)));
-        }
+    public:
+
+        // Constructors
+        NodeHandle() = default;
+        NodeHandle(K&& key, T&& value) :
+            heldKey(std::move(key)), heldValue(std::move(value)), empty(false)
+        {};
 
-        // Equality operator
-        bool operator==(const Node& other) const {
-            return key() == other.key() && value() == other.value();
+        // Move only
+        NodeHandle(NodeHandle&& other) = default;
+        NodeHandle& operator=(NodeHandle&& other) = default;
+        NodeHandle(const NodeHandle& other) = delete;
+        NodeHandle& operator=(const NodeHandle& other) = delete;
+
+        bool is_empty() const {
+            return empty;
         }
-    
-    protected:
-        // Key getters (used for setting too)
+        explicit operator bool() const {
+            return !empty;
+        }
+
+        /// @note Don't change the key of a handle that is going to be inserted
+        ///   unless it's still unique in the target tree.
         K& key() {
-            return static_cast<NodeType*>(this)->_key();
+            return heldKey;
         }
         const K& key() const {
-            return static_cast<const NodeType*>(this)->_key();
+            return heldKey;
         }
 
-        // Value getters (used for setting too)
         T& value() {
-            return static_cast<NodeType*>(this)->_value();
+            return heldValue;
         }
         const T& value() const {
-            return static_cast<const NodeType*>(this)->_value();
+            return heldValue;
+        }
+
+        // Drop the held key and value (they may have been moved from).
+        void reset() {
+            empty = true;
         }
     };
 
@@ -73,16 +85,25 @@ namespace Tree {
     // `K` has to be comparable (`operator<`, `operator==`).
     // `K` and `T` have to be moveable (have a move assignment operator).
     // TreeType is the type of the tree (AVL, RedBlack, etc.).
-    // See `trees/avl/avl.h` for an example.
+    // See `trees/avl.h` for an example.
     // 
     // Implementations should inherit from this class.
     // They must implement the following functions:
     // - Copy and move assignment operators.
-    // - `Node<T, K, NodeType>* _get(const K& key) const`
+    // - `T* _get(const K& key)`
+    // - `const T* _get(const K& key) const`
     // - `bool _insert(const K&& key, const T&& value)`
+    // - `bool _set(const K& key, const T&& value)`
     // - `bool _remove(const K& key)`
+    // - `NodeHandle<T, K> _extract(const K& key)`
+    // - `bool _insert(NodeHandle<T, K>&& node)`
+    // - `size_t _merge(OtherTreeType& other)`, recording each moved entry (see `merge`)
+    // - `bool _equals(const TreeType& other) const`
     // - `size_t _size() const`
     // - `void _clear()`
+    // - Optionally `Position` and `Position _insert_hint(Position hint, const K&& key, const T&& value)`,
+    //   for `insert_hint`.
+    // - `AugmentType`, the augmentation, see `trees/generic/augment.h` (`NoAugment` if there's none).
     template <class T, class K, size_t Size, class TreeType>
     class Tree {
 
@@ -93,8 +114,9 @@ namespace Tree {
         // using NodeType = typename TreeType<T, K, Size>::NodeType;
 
         // Internal get
-        /// @returns `nullptr` if key doesn't exist
-        // Node<T, K, NodeType>* _get(const K& key) const {
+        // Only loads the value (which may live apart from the key) on a hit.
+        /// @returns pointer to the value, `nullptr` if key doesn't exist
+        // T* _get(const K& key) const {
         //     return static_cast<TreeType*>(this)._get(key);
         // }
 
@@ -117,13 +139,13 @@ namespace Tree {
         //     return static_cast<const TreeType*>(this)._size();
         // }
 
-        // Recursively compare node trees (don't actually use recursion, please)
-        // TODO: How should this work?
-        //   Ideally, two HashMaps are created to compare the trees only by keys and values.
-        //   This should eventually become a mandatory to implement function.
-        // static bool compareNodeTrees(const Node<T, K, NodeType>* a, const Node<T, K, NodeType>* b) {
-        //     return TreeType::compareNodeTrees(a, b);
-        // };
+        // Operation recorder, `nullptr` if not recording.
+        TraceRecorder* recorder = nullptr;
+
+        void record(TraceOp op, const K& key) const {
+            if (recorder != nullptr)
+                recorder->record(op, traceKey(key));
+        }
 
     public:
 
@@ -150,14 +172,28 @@ namespace Tree {
         }
 
         // Equality operators
-        // bool operator==(const Tree& other) const {
-        //     return TreeType::compareNodeTrees(
-        //         static_cast<TreeType*>(this)._root(),
-        //         static_cast<const TreeType&>(other)._root());
-        // }
+        // Compares keys and values, not the shape of the trees.
+        bool operator==(const Tree& other) const {
+            return static_cast<const TreeType*>(this)->_equals(static_cast<const TreeType&>(other));
+        }
+        bool operator!=(const Tree& other) const {
+            return !(*this == other);
+        }
+
+        // Diff
+        // Only for trees with a hash augmentation, see `trees/generic/merkle.h`.
+        // Calls `fn(const K& key, const T* value, const T* otherValue)` in key order
+        // for every key missing from one of the trees (`nullptr` value) or with different values.
+        template <class Fn>
+        void diff(const Tree& other, Fn&& fn) const {
+            static_cast<const TreeType*>(this)->_diff(static_cast<const TreeType&>(other), fn);
+        }
 
         // Index operators
+        // The mutable one is only available without augmentation, use `set` otherwise.
         /// @throws std::out_of_range if key doesn't exist
+        template <class Tr = TreeType, typename std::enable_if<
+            std::is_empty<typename Tr::AugmentType::Data>::value, int>::type = 0>
         T& operator[](const K& key) {
             return get(key);
         }
@@ -184,6 +220,7 @@ namespace Tree {
 
         // Contains
         /*[[nodiscard]]*/ bool contains_key(const K& key) const {
+            record(TraceOp::Get, key);
             return static_cast<const TreeType*>(this)->_get(key) != nullptr;
         }
         // /*[[nodiscard]]*/ bool contains_value(const T& value) const {
@@ -191,7 +228,11 @@ namespace Tree {
         // }
 
         // Get
+        // The mutable one is only available without augmentation:
+        // augmented trees have to recompute it when a value changes, use `set`.
         /// @throws std::out_of_range if key doesn't exist
+        template <class Tr = TreeType, typename std::enable_if<
+            std::is_empty<typename Tr::AugmentType::Data>::value, int>::type = 0>
         /*[[nodiscard]]*/ T& get(const K& key);
         /// @throws std::out_of_range if key doesn't exist
         /*[[nodiscard]]*/ const T& get(const K& key) const;
@@ -205,23 +246,88 @@ namespace Tree {
         // Insert
         /// @returns true if the key was inserted, false otherwise (tree full).
         /*[[nodiscard]]*/ bool insert(const K&& key, const T&& value) {
+            record(TraceOp::Insert, key);
             return static_cast<TreeType*>(this)->_insert(std::move(key), std::move(value));
         }
 
+        // Hinted insert
+        // Only for trees with positions, see `trees/avl.h`.
+        // Insertion starts from @p hint (from `position` or a previous `insert_hint`) instead of the root.
+        // `insert` already starts next to the last inserted node, hints help around other nodes.
+        /// @returns position of the inserted node, empty if the tree is full.
+        /// @throws std::invalid_argument if the key already exists.
+        template <class Tr = TreeType>
+        typename Tr::Position insert_hint(typename Tr::Position hint, const K&& key, const T&& value) {
+            record(TraceOp::Insert, key);
+            return static_cast<Tr*>(this)->_insert_hint(hint, std::move(key), std::move(value));
+        }
+
         // Set
         /// @returns true if the key was set, false otherwise (key doesn't exist).
-        /*[[nodiscard]]*/ bool set(const K& key, const T&& value);
+        /*[[nodiscard]]*/ bool set(const K& key, const T&& value) {
+            record(TraceOp::Set, key);
+            return static_cast<TreeType*>(this)->_set(key, std::move(value));
+        }
 
         // Remove
         /// @returns true if the key was removed, false otherwise (key doesn't exist).
         bool remove(const K& key) {
+            record(TraceOp::Remove, key);
             return static_cast<TreeType*>(this)->_remove(key);
         }
 
+        // Extract
+        // Takes the key and value out of the tree without copying them.
+        /// @returns a handle owning the key and value, empty if the key doesn't exist.
+        /*[[nodiscard]]*/ NodeHandle<T, K> extract(const K& key) {
+            record(TraceOp::Remove, key);
+            return static_cast<TreeType*>(this)->_extract(key);
+        }
+
+        // Insert node
+        // Moves the key and value of @p node into the tree. Doesn't throw.
+        /// @returns true if the node was inserted (@p node is emptied),
+        ///   false otherwise (@p node is empty, tree full or key exists), @p node keeps its key and value.
+        bool insert(NodeHandle<T, K>&& node) {
+            if (!node.is_empty())
+                record(TraceOp::Insert, node.key());
+            return static_cast<TreeType*>(this)->_insert(std::move(node));
+        }
+
+        // Merge
+        // Moves every entry of @p other whose key isn't in this tree yet, until this tree is full.
+        // Entries that weren't moved stay in @p other. Doesn't throw.
+        // Each moved entry is recorded as a remove from @p other and an insert into this tree.
+        /// @returns count of moved entries.
+        template <size_t OtherSize, class OtherTreeType>
+        size_t merge(Tree<T, K, OtherSize, OtherTreeType>& other) {
+            return static_cast<TreeType*>(this)->_merge(static_cast<OtherTreeType&>(other));
+        }
+
         // Clear
         void clear() {
+            if (recorder != nullptr)
+                recorder->record(TraceOp::Clear, 0);
             static_cast<TreeType*>(this)->_clear();
         }
+
+        // Aggregate
+        // Only for trees with an aggregate augmentation, see `trees/generic/augment.h`.
+        /// @returns the values with keys in `[lo, hi)` combined in key order,
+        ///   the monoid identity if there are none.
+        /*[[nodiscard]]*/ auto aggregate(const K& lo, const K& hi) const {
+            return static_cast<const TreeType*>(this)->_aggregate(lo, hi);
+        }
+
+        // Recording
+        // Records `insert`, `get` (also `try_get`, `contains_key`, `operator[]`),
+        // `set`, `remove` and `clear` calls into @p recorder until it's set to `nullptr`.
+        // See `trace.h`, a recorder records a single tree.
+        // Only available for integral, enum and `std::hash`able keys.
+        void set_recorder(TraceRecorder* recorder) {
+            static_assert(IsTraceable<K>::value, "Key type can't be traced, specialize std::hash for it");
+            this->recorder = recorder;
+        }
     };
 } // namespace Tree
 
@@ -1,229 +1,549 @@
 #include "avl.h"
 
+#include <algorithm>
 #include <stdexcept>
+#include <type_traits>
 
 
 namespace Tree {
 
-template <class T, class K, size_t Size>
-Node<T, K, typename AVLTree<T, K, Size>::NodeType>* AVLTree<T, K, Size>::_get(const K& key) const {
-    auto* current = root;
+template <class T, class K, size_t Size, template<class, class, size_t> class Storage, class Augment, size_t CacheSize>
+Slot AVLTree<T, K, Size, Storage, Augment, CacheSize>::find(const K& key, std::true_type) const {
+    auto& cached = cache.entry(key);
+    if (cached != NoSlot && node(cached).key == key) {
+        cache.hit();
+        return cached;
+    }
+    cache.miss();
+
+    auto slot = find(key, std::false_type{});
+    if (slot != NoSlot)
+        cached = slot;
+    return slot;
+}
 
-    while (current != nullptr)
-        if (key < current->key)
-            current = current->left;
-        else if (key > current->key)
-            current = current->right;
+template <class T, class K, size_t Size, template<class, class, size_t> class Storage, class Augment, size_t CacheSize>
+Slot AVLTree<T, K, Size, Storage, Augment, CacheSize>::find(const K& key, std::false_type) const {
+    auto current = root;
+
+    // Only the hot part is touched here
+    while (current != NoSlot) {
+        const auto& n = node(current);
+        if (key < n.key)
+            current = n.left;
+        else if (n.key < key)
+            current = n.right;
         else
             return current;
+    }
+
+    return NoSlot;
+}
+
+template <class T, class K, size_t Size, template<class, class, size_t> class Storage, class Augment, size_t CacheSize>
+bool AVLTree<T, K, Size, Storage, Augment, CacheSize>::descend(Slot current, const K& key, Place& place) const {
+    while (current != NoSlot) {
+        place.parent = current;
+        const auto& n = node(current);
+        if (key < n.key) {
+            place.succ = current;
+            current = n.left;
+        } else if (n.key < key) {
+            place.pred = current;
+            current = n.right;
+        } else {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+template <class T, class K, size_t Size, template<class, class, size_t> class Storage, class Augment, size_t CacheSize>
+bool AVLTree<T, K, Size, Storage, Augment, CacheSize>::findPlaceFrom(Slot start, const K& key, Place& place) const {
+    place = Place{};
+
+    if (start == NoSlot)
+        return descend(root, key, place);
+
+    // Climb until the subtree is bounded by a node on the other side of `key`,
+    // the place of `key` is in that subtree
+    auto current = start;
+    bool left = key < node(current).key;
+    while (node(current).parent != NoSlot) {
+        auto parent = node(current).parent;
+        const auto& p = node(parent);
+
+        if (left && p.right == current) {
+            if (p.key < key) {
+                place.pred = parent;
+                break;
+            }
+            if (!(key < p.key))
+                return false;
+        } else if (!left && p.left == current) {
+            if (key < p.key) {
+                place.succ = parent;
+                break;
+            }
+            if (!(p.key < key))
+                return false;
+        }
+
+        current = parent;
+    }
+
+    return descend(current, key, place);
+}
+
+template <class T, class K, size_t Size, template<class, class, size_t> class Storage, class Augment, size_t CacheSize>
+bool AVLTree<T, K, Size, Storage, Augment, CacheSize>::findPlace(const K& key, Place& place) const {
+    if (finger == NoSlot)
+        return findPlaceFrom(NoSlot, key, place);
+
+    // Right next to the finger, no search needed.
+    // Of two in-order neighbours one is an ancestor of the other,
+    // so one of the links between them is free.
+    const auto& f = node(finger);
+    if (key < f.key) {
+        if (fingerPred == NoSlot || node(fingerPred).key < key) {
+            place.parent = f.left == NoSlot ? finger : fingerPred;
+            place.pred = fingerPred;
+            place.succ = finger;
+            return true;
+        }
+    } else if (f.key < key) {
+        if (fingerSucc == NoSlot || key < node(fingerSucc).key) {
+            place.parent = f.right == NoSlot ? finger : fingerSucc;
+            place.pred = finger;
+            place.succ = fingerSucc;
+            return true;
+        }
+    } else {
+        return false;
+    }
+
+    return findPlaceFrom(finger, key, place);
+}
+
+template <class T, class K, size_t Size, template<class, class, size_t> class Storage, class Augment, size_t CacheSize>
+T* AVLTree<T, K, Size, Storage, Augment, CacheSize>::_get(const K& key) {
+    auto slot = find(key);
+    return slot == NoSlot ? nullptr : &nodes.value(slot);
+}
+
+template <class T, class K, size_t Size, template<class, class, size_t> class Storage, class Augment, size_t CacheSize>
+const T* AVLTree<T, K, Size, Storage, Augment, CacheSize>::_get(const K& key) const {
+    auto slot = find(key);
+    return slot == NoSlot ? nullptr : &nodes.value(slot);
+}
+
+
+template <class T, class K, size_t Size, template<class, class, size_t> class Storage, class Augment, size_t CacheSize>
+Slot AVLTree<T, K, Size, Storage, Augment, CacheSize>::allocate() {
+    if (freeList != NoSlot) {
+        auto slot = freeList;
+        freeList = node(slot).right;
+        node(slot).right = NoSlot;
+        return slot;
+    }
+    return used++;
+}
+
+template <class T, class K, size_t Size, template<class, class, size_t> class Storage, class Augment, size_t CacheSize>
+void AVLTree<T, K, Size, Storage, Augment, CacheSize>::release(Slot slot) {
+    // Height 0 means node doesn't exist
+    node(slot) = NodeType{};
+    node(slot).right = freeList;
+    freeList = slot;
+
+    // Don't hold on to whatever the value owns
+    nodes.value(slot) = T{};
+}
 
-    return nullptr;
+template <class T, class K, size_t Size, template<class, class, size_t> class Storage, class Augment, size_t CacheSize>
+void AVLTree<T, K, Size, Storage, Augment, CacheSize>::replaceChild(Slot parent, Slot from, Slot to) {
+    if (parent == NoSlot)
+        root = to;
+    else if (node(parent).left == from)
+        node(parent).left = to;
+    else
+        node(parent).right = to;
+
+    if (to != NoSlot)
+        node(to).parent = parent;
 }
 
 
-template <class T, class K, size_t Size>
-void rotateLeft(AVLNode<T, K>* node) {
-    auto* right = node->right;
-    node->right = right->left;
-    right->left = node;
-    node->height = std::max(node->left->height, node->right->height) + 1;
-    right->height = std::max(right->left->height, right->right->height) + 1;
-    node = right;
+template <class T, class K, size_t Size, template<class, class, size_t> class Storage, class Augment, size_t CacheSize>
+void AVLTree<T, K, Size, Storage, Augment, CacheSize>::update(Slot slot) {
+    auto& n = node(slot);
+    n.height = std::max(height(n.left), height(n.right)) + 1;
+    Augment::update(n, nodes.value(slot),
+        n.left == NoSlot ? nullptr : &node(n.left),
+        n.right == NoSlot ? nullptr : &node(n.right));
 }
 
-template <class T, class K, size_t Size>
-void rotateRight(AVLNode<T, K>* node) {
-    auto* left = node->left;
-    node->left = left->right;
-    left->right = node;
-    node->height = std::max(node->left->height, node->right->height) + 1;
-    left->height = std::max(left->left->height, left->right->height) + 1;
-    node = left;
+template <class T, class K, size_t Size, template<class, class, size_t> class Storage, class Augment, size_t CacheSize>
+Slot AVLTree<T, K, Size, Storage, Augment, CacheSize>::rotateLeft(Slot slot) {
+    auto right = node(slot).right;
+
+    replaceChild(node(slot).parent, slot, right);
+
+    node(slot).right = node(right).left;
+    if (node(slot).right != NoSlot)
+        node(node(slot).right).parent = slot;
+
+    node(right).left = slot;
+    node(slot).parent = right;
+
+    update(slot);
+    update(right);
+    return right;
 }
 
-template <class T, class K, size_t Size>
-void rotateLeftRight(AVLNode<T, K>* node) {
-    rotateLeft(node->left);
-    rotateRight(node);
+template <class T, class K, size_t Size, template<class, class, size_t> class Storage, class Augment, size_t CacheSize>
+Slot AVLTree<T, K, Size, Storage, Augment, CacheSize>::rotateRight(Slot slot) {
+    auto left = node(slot).left;
+
+    replaceChild(node(slot).parent, slot, left);
+
+    node(slot).left = node(left).right;
+    if (node(slot).left != NoSlot)
+        node(node(slot).left).parent = slot;
+
+    node(left).right = slot;
+    node(slot).parent = left;
+
+    update(slot);
+    update(left);
+    return left;
 }
 
-template <class T, class K, size_t Size>
-void rotateRightLeft(AVLNode<T, K>* node) {
-    rotateRight(node->right);
-    rotateLeft(node);
+template <class T, class K, size_t Size, template<class, class, size_t> class Storage, class Augment, size_t CacheSize>
+Slot AVLTree<T, K, Size, Storage, Augment, CacheSize>::rotateLeftRight(Slot slot) {
+    rotateLeft(node(slot).left);
+    return rotateRight(slot);
 }
 
-template <class T, class K, size_t Size>
-void balance(AVLNode<T, K>* node) {
+template <class T, class K, size_t Size, template<class, class, size_t> class Storage, class Augment, size_t CacheSize>
+Slot AVLTree<T, K, Size, Storage, Augment, CacheSize>::rotateRightLeft(Slot slot) {
+    rotateRight(node(slot).right);
+    return rotateLeft(slot);
+}
+
+template <class T, class K, size_t Size, template<class, class, size_t> class Storage, class Augment, size_t CacheSize>
+Slot AVLTree<T, K, Size, Storage, Augment, CacheSize>::balance(Slot slot) {
     // Height 1 means leafs
     // Height 0 means node doesn't exist
 
-    if (node->left->height - node->right->height == 2) {
-        if (node->left->left->height > node->left->right->height)
-            rotateRight(node);
+    auto factor = balanceFactor(slot);
+
+    if (factor == 2) {
+        if (balanceFactor(node(slot).left) >= 0)
+            return rotateRight(slot);
         else
-            rotateLeftRight(node);
-    } else if (node->right->height - node->left->height == 2) {
-        if (node->right->right->height > node->right->left->height)
-            rotateLeft(node);
+            return rotateLeftRight(slot);
+    } else if (factor == -2) {
+        if (balanceFactor(node(slot).right) <= 0)
+            return rotateLeft(slot);
         else
-            rotateRightLeft(node);
+            return rotateRightLeft(slot);
     }
+
+    return slot;
+}
+
+template <class T, class K, size_t Size, template<class, class, size_t> class Storage, class Augment, size_t CacheSize>
+void AVLTree<T, K, Size, Storage, Augment, CacheSize>::rebalanceUp(Slot slot) {
+    while (slot != NoSlot) {
+        auto before = node(slot).height;
+        update(slot);
+        slot = balance(slot);
+
+        // Nothing above depends on this subtree but its height (and augmentation)
+        if (node(slot).height == before) {
+            updateUp(node(slot).parent);
+            return;
+        }
+
+        slot = node(slot).parent;
+    }
+}
+
+
+template <class T, class K, size_t Size, template<class, class, size_t> class Storage, class Augment, size_t CacheSize>
+template <class KeyArg, class ValueArg>
+Slot AVLTree<T, K, Size, Storage, Augment, CacheSize>::attach(const Place& place, KeyArg&& key, ValueArg&& value) {
+    // Find a place in the pool to store a new node
+    auto slot = allocate();
+
+    auto& n = node(slot);
+    n.key = std::forward<KeyArg>(key);
+    n.height = 1;
+    nodes.value(slot) = std::forward<ValueArg>(value);
+
+    auto parent = place.parent;
+    if (parent == NoSlot)
+        root = slot;
+    else if (node(slot).key < node(parent).key)
+        node(parent).left = slot;
+    else
+        node(parent).right = slot;
+    node(slot).parent = parent;
+
+    update(slot);
+    rebalanceUp(parent);
+
+    finger = slot;
+    fingerPred = place.pred;
+    fingerSucc = place.succ;
+
+    count++;
+    return slot;
 }
 
+template <class T, class K, size_t Size, template<class, class, size_t> class Storage, class Augment, size_t CacheSize>
+void AVLTree<T, K, Size, Storage, Augment, CacheSize>::unlink(Slot current) {
+    cache.forget(node(current).key, current);
+
+    // The finger's neighbours change
+    if (current == finger || current == fingerPred || current == fingerSucc)
+        finger = NoSlot;
+
+    // Nodes are relinked, never moved, so values stay in their slots
+    Slot rebalanceFrom;
+    if (node(current).left == NoSlot || node(current).right == NoSlot) {
+        // Node has at most one child, replace the node with it
+        auto child = node(current).left != NoSlot ? node(current).left : node(current).right;
+        rebalanceFrom = node(current).parent;
+        replaceChild(rebalanceFrom, current, child);
+    } else {
+        // Node has both children
+        // Find the smallest node in the right subtree
+        auto smallest = node(current).right;
+        while (node(smallest).left != NoSlot)
+            smallest = node(smallest).left;
+
+        // Replace the smallest node with its right child
+        if (smallest == node(current).right) {
+            rebalanceFrom = smallest;
+        } else {
+            rebalanceFrom = node(smallest).parent;
+            replaceChild(rebalanceFrom, smallest, node(smallest).right);
+            node(smallest).right = node(current).right;
+            node(node(smallest).right).parent = smallest;
+        }
+
+        // Replace the node with the smallest node
+        node(smallest).height = node(current).height;
+        node(smallest).left = node(current).left;
+        node(node(smallest).left).parent = smallest;
+        replaceChild(node(current).parent, current, smallest);
+    }
+
+    // Balance the tree
+    rebalanceUp(rebalanceFrom);
 
-template <class T, class K, size_t Size>
-bool AVLTree<T, K, Size>::_insert(const K&& key, const T&& value) {
+    count--;
+}
+
+
+template <class T, class K, size_t Size, template<class, class, size_t> class Storage, class Augment, size_t CacheSize>
+bool AVLTree<T, K, Size, Storage, Augment, CacheSize>::_insert(const K&& key, const T&& value) {
     if (count == Size)
         return false;
 
-    if (root == nullptr) {
-        nodes[0] = Node<T, K, NodeType>(std::move(key), std::move(value));
-        root = &nodes[0];
-        count++;
-        return true;
-    }
-    
-    // Height 1 means leafs
-    // Height 0 means node doesn't exist
-    // All nodes in array are initialized with height 0 on tree creation
-    // Don't allocate memory for new node, use array instead
-    // Find an empty node in the array and replace it with a new one
-    
     // First, find a place in the tree for a new node
-    auto* current = root;
-    auto* parrent = root;
-    while (current != nullptr) {
-        parrent = current;
-        if (key < current->key)
-            current = current->left;
-        else
-            current = current->right;
-    }
+    Place place;
+    if (!findPlace(key, place))
+        throw std::invalid_argument("Key already exists");
 
-    // Check if key already exists
-    if (parrent->key == key)
+    // Second, insert a new node
+    attach(place, std::move(key), std::move(value));
+    return true;
+}
+
+template <class T, class K, size_t Size, template<class, class, size_t> class Storage, class Augment, size_t CacheSize>
+typename AVLTree<T, K, Size, Storage, Augment, CacheSize>::Position AVLTree<T, K, Size, Storage, Augment, CacheSize>::_insert_hint(Position hint, const K&& key, const T&& value) {
+    if (count == Size)
+        return Position{};
+
+    // Removed nodes are no hint
+    auto start = hint.slot != NoSlot && node(hint.slot).height != 0 ? hint.slot : NoSlot;
+
+    Place place;
+    if (!findPlaceFrom(start, key, place))
         throw std::invalid_argument("Key already exists");
 
-    // Second, find a place in the array to store a new node
-    auto* node = &nodes[0];
-    while (node->height != 0)
-        node++;
+    return Position{attach(place, std::move(key), std::move(value))};
+}
 
-    // Third, insert a new node
-    *node = NodeType(std::move(key), std::move(value), 1);
+template <class T, class K, size_t Size, template<class, class, size_t> class Storage, class Augment, size_t CacheSize>
+void AVLTree<T, K, Size, Storage, Augment, CacheSize>::updateUp(Slot slot) {
+    // Plain trees have nothing to update
+    if (std::is_empty<typename Augment::Data>::value)
+        return;
 
-    count++;
+    for (; slot != NoSlot; slot = node(slot).parent)
+        update(slot);
+}
+
+
+template <class T, class K, size_t Size, template<class, class, size_t> class Storage, class Augment, size_t CacheSize>
+bool AVLTree<T, K, Size, Storage, Augment, CacheSize>::_set(const K& key, const T&& value) {
+    // Writes don't go through the lookup cache, its stats are for sizing it for reads
+    auto slot = find(key, std::false_type{});
+
+    if (slot == NoSlot)
+        return false;
+
+    nodes.value(slot) = std::move(value);
+    updateUp(slot);
     return true;
 }
 
-template <class T, class K, size_t Size>
-bool AVLTree<T, K, Size>::_remove(const K& key) {
-    // Height 1 means leafs
-    // Height 0 means node doesn't exist
-    // All nodes in array are initialized with height 0 on tree creation
-    // To delete a node in the array, just set its height
-    // But first delete it from the tree
-
-    // First, find the node to delete
-    auto* current = root;
-    auto* parrent = root;
-    while (current != nullptr) {
-        if (key < current->key) {
-            parrent = current;
-            current = current->left;
-        } else if (key > current->key) {
-            parrent = current;
-            current = current->right;
-        } else
-            break;
-    }
+template <class T, class K, size_t Size, template<class, class, size_t> class Storage, class Augment, size_t CacheSize>
+bool AVLTree<T, K, Size, Storage, Augment, CacheSize>::_remove(const K& key) {
+    // First, find the node to delete (uncached, it's about to go away)
+    auto slot = find(key, std::false_type{});
 
     // Check if key exists
-    if (current == nullptr)
+    if (slot == NoSlot)
         return false;
 
     // Second, delete the node from the tree
-    if (current->left == nullptr && current->right == nullptr) {
-        // Node is a leaf
-        if (current == root) {
-            // Node is root
-            root = nullptr;
-        } else if (parrent->left == current) {
-            // Node is left child
-            parrent->left = nullptr;
-        } else {
-            // Node is right child
-            parrent->right = nullptr;
-        }
-    } else if (current->left == nullptr) {
-        // Node has only right child
-        if (current == root) {
-            // Node is root
-            root = current->right;
-        } else if (parrent->left == current) {
-            // Node is left child
-            parrent->left = current->right;
-        } else {
-            // Node is right child
-            parrent->right = current->right;
-        }
-    } else if (current->right == nullptr) {
-        // Node has only left child
-        if (current == root) {
-            // Node is root
-            root = current->left;
-        } else if (parrent->left == current) {
-            // Node is left child
-            parrent->left = current->left;
-        } else {
-            // Node is right child
-            parrent->right = current->left;
-        }
-    } else {
-        // Node has both children
-        // Find the smallest node in the right subtree
-        auto* smallest = current->right;
-        auto* smallestParrent = current;
-        while (smallest->left != nullptr) {
-            smallestParrent = smallest;
-            smallest = smallest->left;
-        }
+    unlink(slot);
 
-        // Replace the node with the smallest node
-        if (current == root) {
-            // Node is root
-            root = smallest;
-        } else if (parrent->left == current) {
-            // Node is left child
-            parrent->left = smallest;
-        } else {
-            // Node is right child
-            parrent->right = smallest;
-        }
+    // Third, delete the node from the pool
+    release(slot);
+    return true;
+}
 
-        // Replace the smallest node with its right child
-        if (smallestParrent->left == smallest) {
-            // Smallest node is left child
-            smallestParrent->left = smallest->right;
-        } else {
-            // Smallest node is right child
-            smallestParrent->right = smallest->right;
-        }
 
-        // Replace the smallest
-        smallest->left = current->left;
-        smallest->right = current->right;
+template <class T, class K, size_t Size, template<class, class, size_t> class Storage, class Augment, size_t CacheSize>
+NodeHandle<T, K> AVLTree<T, K, Size, Storage, Augment, CacheSize>::_extract(const K& key) {
+    // Uncached, the node is about to go away
+    auto slot = find(key, std::false_type{});
+
+    if (slot == NoSlot)
+        return NodeHandle<T, K>();
 
-        // Balance the tree
-        balance(smallest);
+    unlink(slot);
+
+    // Move the key and value out before the slot is released
+    NodeHandle<T, K> handle(std::move(node(slot).key), std::move(nodes.value(slot)));
+    release(slot);
+    return handle;
+}
+
+template <class T, class K, size_t Size, template<class, class, size_t> class Storage, class Augment, size_t CacheSize>
+bool AVLTree<T, K, Size, Storage, Augment, CacheSize>::_insert(NodeHandle<T, K>&& handle) {
+    if (handle.is_empty() || count == Size)
+        return false;
+
+    Place place;
+    if (!findPlace(handle.key(), place))
+        return false;
+
+    attach(place, std::move(handle.key()), std::move(handle.value()));
+    handle.reset();
+    return true;
+}
+
+template <class T, class K, size_t Size, template<class, class, size_t> class Storage, class Augment, size_t CacheSize>
+template <size_t OtherSize, template<class, class, size_t> class OtherStorage, class OtherAugment, size_t OtherCacheSize>
+size_t AVLTree<T, K, Size, Storage, Augment, CacheSize>::_merge(AVLTree<T, K, OtherSize, OtherStorage, OtherAugment, OtherCacheSize>& other) {
+    if (static_cast<void*>(&other) == static_cast<void*>(this))
+        return 0;
+
+    // Unlinking only relinks nodes, so walking the other pool by slot is stable
+    size_t moved = 0;
+    for (Slot slot = 0; slot < other.used && count < Size; slot++) {
+        auto& n = other.node(slot);
+        if (n.height == 0)
+            continue;
+
+        Place place;
+        if (!findPlace(n.key, place))
+            continue;
+
+        other.record(TraceOp::Remove, n.key);
+        this->record(TraceOp::Insert, n.key);
+
+        // The value is moved once, straight from slot to slot
+        other.unlink(slot);
+        attach(place, std::move(n.key), std::move(other.nodes.value(slot)));
+        other.release(slot);
+        moved++;
     }
 
+    return moved;
+}
 
-    // Third, delete the node from the array
-    current->height = 0;
+template <class T, class K, size_t Size, template<class, class, size_t> class Storage, class Augment, size_t CacheSize>
+void AVLTree<T, K, Size, Storage, Augment, CacheSize>::_clear() {
+    for (Slot slot = 0; slot < used; slot++) {
+        node(slot) = NodeType{};
+        nodes.value(slot) = T{};
+    }
+
+    root = NoSlot;
+    count = 0;
+    used = 0;
+    freeList = NoSlot;
+    finger = NoSlot;
+    cache.clear();
+}
+
+
+template <class T, class K, size_t Size, template<class, class, size_t> class Storage, class Augment, size_t CacheSize>
+Slot AVLTree<T, K, Size, Storage, Augment, CacheSize>::first() const {
+    auto current = root;
+    if (current != NoSlot)
+        while (node(current).left != NoSlot)
+            current = node(current).left;
+    return current;
+}
+
+template <class T, class K, size_t Size, template<class, class, size_t> class Storage, class Augment, size_t CacheSize>
+Slot AVLTree<T, K, Size, Storage, Augment, CacheSize>::next(Slot slot) const {
+    // Smallest node of the right subtree
+    if (node(slot).right != NoSlot) {
+        slot = node(slot).right;
+        while (node(slot).left != NoSlot)
+            slot = node(slot).left;
+        return slot;
+    }
+
+    // First ancestor this subtree is on the left of
+    auto parent = node(slot).parent;
+    while (parent != NoSlot && node(parent).right == slot) {
+        slot = parent;
+        parent = node(slot).parent;
+    }
+    return parent;
+}
+
+
+template <class T, class K, size_t Size, template<class, class, size_t> class Storage, class Augment, size_t CacheSize>
+bool AVLTree<T, K, Size, Storage, Augment, CacheSize>::equals(const AVLTree& other, std::true_type) const {
+    // Different hashes mean different contents, equal ones may collide
+    return probably_equal(other) && equals(other, std::false_type{});
+}
+
+template <class T, class K, size_t Size, template<class, class, size_t> class Storage, class Augment, size_t CacheSize>
+bool AVLTree<T, K, Size, Storage, Augment, CacheSize>::equals(const AVLTree& other, std::false_type) const {
+    if (count != other.count)
+        return false;
+
+    // Walk both trees in key order, shapes may differ
+    auto a = first();
+    auto b = other.first();
+    for (; a != NoSlot; a = next(a), b = other.next(b))
+        if (!(node(a).key == other.node(b).key) || !(nodes.value(a) == other.nodes.value(b)))
+            return false;
 
-    count--;
     return true;
 }
 
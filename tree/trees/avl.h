@@ -2,67 +2,81 @@
 #define TREE_AVL_H
 
 #include "tree.h"
+#include "trees/generic/augment.h"
+#include "trees/generic/cache.h"
+#include "trees/generic/merkle.h"
+#include "trees/generic/storage.h"
 
 #include <array>
+#include <type_traits>
 
 
 namespace Tree {
 
-// Implementations should inherit from `Node` class.
-// They must implement the following functions:
-// - Default constructor. `Tree`s may allocate `std::array`s of nodes on creation.
-// - Move assignment operators.
-// - Equality operator. Only compares the node's key and value.
-// - `K& _key()`
-// - `const K& _key() const`
-// - `T& _value()`
-// - `const T& _value() const`
-
-template<class T, class K>
-class AVLNode : public Node<T, K, AVLNode<T, K>> {
-    using NodeType = AVLNode;
-
+// Hot part of an AVL node: everything a descent or a rotation touches.
+// The value lives in the tree's storage, next to it or in a separate array.
+// `Data` is the augmentation data, see `trees/generic/augment.h`.
+template<class K, class Data = NoAugment::Data>
+struct AVLNode : Data {
     K key{};
-    T value{};
 
-    Node<T, K, NodeType>* left = nullptr;
-    Node<T, K, NodeType>* right = nullptr;
+    Slot parent = NoSlot;
+    Slot left = NoSlot;
+    Slot right = NoSlot;
 
     // Height of the subtree with this node as root.
     // 1 means leaf. 0 means doesn't exist.
-    size_t height = 0;
-
-public:
-
-    // Constructors
-    AVLNode() = default;
-    AVLNode(const K&& key, const T&& value, size_t height) :
-        key(std::move(key)), value(std::move(value)), height(height)
-    {};
-
-    bool operator==(const NodeType& other) const {
-        return key == other.key && value == other.value;
-    }
-
-    // Assignment operators
-    NodeType& operator=(NodeType&& other) = default;
+    uint8_t height = 0;
 };
 
 
  // Implementations should inherit from `Tree` class.
 // They must implement the following functions:
 // - Copy and move assignment operators.
-// - `Node<T, K, NodeType>* _get(const K& key) const`
+// - `T* _get(const K& key)`
+// - `const T* _get(const K& key) const`
 // - `bool _insert(const K&& key, const T&& value)`
+// - `bool _set(const K& key, const T&& value)`
 // - `bool _remove(const K& key)`
+// - `NodeHandle<T, K> _extract(const K& key)`
+// - `bool _insert(NodeHandle<T, K>&& node)`
+// - `size_t _merge(OtherTreeType& other)`, recording each moved entry (see `merge`)
+// - `bool _equals(const TreeType& other) const`
 // - `size_t _size() const`
 // - `void _clear()`
+// - `AugmentType`
+// - `Position _insert_hint(Position hint, const K&& key, const T&& value)`
+//
+// `Storage` is the layout of the node pool, see `trees/generic/storage.h`.
+// Use `SplitStorage` when values are much bigger than keys.
+// Insertion starts from a "finger" at the last inserted node: inserting right next to it
+// (between it and an in-order neighbour) is O(1), so sorted appends are amortised O(1).
+// Other inserts are O(log n), see `insert_hint` too.
+// `Augment` is kept up to date in every node, see `trees/generic/augment.h`.
+// With `Aggregate<Monoid>` the tree also implements `_aggregate(lo, hi)`.
+// With `MerkleHash` `_equals` rejects different trees in O(1), `probably_equal` and `_diff` are available.
+// `CacheSize` entries of hot key lookup cache are checked before descending,
+// see `trees/generic/cache.h`. 0 (default) means no cache.
+// With a cache, const lookups (`get`, `try_get`, `contains_key`) write to it:
+// concurrent readers of a cached tree need a lock, unlike without a cache.
+// Only those lookups use the cache, `set`, `remove` and `extract` descend from the root.
 
-template<class T, class K, size_t Size>
-class AVLTree : public Tree<T, K, Size, AVLTree<T, K, Size>> {
+template<class T, class K, size_t Size,
+    template<class, class, size_t> class Storage = PackedStorage,
+    class Augment = NoAugment,
+    size_t CacheSize = 0>
+class AVLTree : public Tree<T, K, Size, AVLTree<T, K, Size, Storage, Augment, CacheSize>> {
 public:
     using TreeType = AVLTree;
-    using NodeType = AVLNode<T, K>;
+    using NodeType = AVLNode<K, typename Augment::Data>;
+    using StorageType = Storage<NodeType, T, Size>;
+    using AugmentType = Augment;
+
+    // Position of a node, for hinted insertion.
+    // Only valid until the node is removed.
+    struct Position {
+        Slot slot = NoSlot;
+    };
 
     // Constructors
     AVLTree() = default;
@@ -76,36 +90,356 @@ public:
     // Destructor
     ~AVLTree() = default;
 
-private:
-    // The array of nodes.
-    std::array<NodeType, Size> nodes{};
+protected:
+    // Trees of other sizes and layouts, for `_merge`.
+    template<class, class, size_t, template<class, class, size_t> class, class, size_t>
+    friend class AVLTree;
+
+    // Upper bound of the tree height.
+    // AVL height is below 1.45 * log2(n + 2), with n < 2^32 that's 47.
+    static constexpr size_t MaxHeight = 48;
+
+    // The pool of nodes.
+    StorageType nodes{};
     // Root node of the tree.
-    NodeType* root = nullptr;
+    Slot root = NoSlot;
     // Count of nodes in the tree.
     size_t count = 0;
+    // Slots below this one have been handed out at least once.
+    Slot used = 0;
+    // Removed slots, chained through `right`.
+    Slot freeList = NoSlot;
+    // Last inserted node and its in-order neighbours at that time.
+    // `NoSlot` neighbours mean it was the smallest or biggest node.
+    Slot finger = NoSlot;
+    Slot fingerPred = NoSlot;
+    Slot fingerSucc = NoSlot;
+    // Hot key lookup cache, filled by const lookups too (not thread-safe).
+    mutable LookupCache<K, CacheSize> cache;
+
+
+    NodeType& node(Slot slot) {
+        return nodes.hot(slot);
+    }
+    const NodeType& node(Slot slot) const {
+        return nodes.hot(slot);
+    }
+
+    uint8_t height(Slot slot) const {
+        return slot == NoSlot ? 0 : node(slot).height;
+    }
+    int balanceFactor(Slot slot) const {
+        return int(height(node(slot).left)) - int(height(node(slot).right));
+    }
+
+    // Slot of the node with `key`, `NoSlot` if there's none.
+    // Goes through the cache if there's one, only use it for lookups.
+    Slot find(const K& key) const {
+        return find(key, std::integral_constant<bool, CacheSize != 0>{});
+    }
+    Slot find(const K& key, std::true_type /* cached */) const;
+    Slot find(const K& key, std::false_type /* not cached */) const;
+
+    // Where a new node goes: below `parent`, between its in-order neighbours `pred` and `succ`.
+    struct Place {
+        Slot parent = NoSlot;
+        Slot pred = NoSlot;
+        Slot succ = NoSlot;
+    };
+    // Find the place of a new node with `key`, starting from the finger.
+    /// @returns false if `key` already exists.
+    bool findPlace(const K& key, Place& place) const;
+    // Find the place of a new node with `key`, climbing up from `start` first.
+    /// @returns false if `key` already exists.
+    bool findPlaceFrom(Slot start, const K& key, Place& place) const;
+    // Find the place of a new node with `key` in the subtree of `slot`.
+    /// @returns false if `key` already exists.
+    bool descend(Slot slot, const K& key, Place& place) const;
+
+    // Slot management
+    Slot allocate();
+    void release(Slot slot);
 
+    // Point `parent`'s link to `from` at `to` instead (`root` if `parent` is `NoSlot`).
+    void replaceChild(Slot parent, Slot from, Slot to);
 
     // AVL balancing functions
-    void rotateLeft(NodeType* node);
-    void rotateRight(NodeType* node);
-    void rotateLeftRight(NodeType* node);
-    void rotateRightLeft(NodeType* node);
-    void balance(NodeType* node);
+    // Each returns the new root of the rotated subtree.
+    void update(Slot slot);
+    Slot rotateLeft(Slot slot);
+    Slot rotateRight(Slot slot);
+    Slot rotateLeftRight(Slot slot);
+    Slot rotateRightLeft(Slot slot);
+    Slot balance(Slot slot);
+    // Update and balance nodes from `slot` up, until a subtree keeps its height.
+    void rebalanceUp(Slot slot);
+    // Update every node from `slot` up to the root, shape doesn't change.
+    void updateUp(Slot slot);
+
+    // In-order walk
+    /// @returns `NoSlot` after the last node.
+    Slot first() const;
+    Slot next(Slot slot) const;
+
+    // Aggregate of the values with keys in `[*lo, *hi)`, `nullptr` bounds are open.
+    template<class A>
+    typename A::Type aggregateRange(const K* lo, const K* hi) const;
+
+    // Rank and select by the `MerkleHash` subtree counts.
+    size_t subtreeCount(Slot slot) const {
+        return slot == NoSlot ? 0 : node(slot).aggregate.count;
+    }
+    // Count of keys below `*key`, 0 if `key` is `nullptr` (open lower bound).
+    size_t rank(const K* key) const;
+    // Slot of the key with `rank`.
+    Slot select(size_t rank) const;
+
+    bool equals(const AVLTree& other, std::true_type /* hashed */) const;
+    bool equals(const AVLTree& other, std::false_type /* not hashed */) const;
+
+    // Attach a new node at `place` (from `findPlace`) and move the finger to it.
+    /// @note Assumes the tree isn't full.
+    template<class KeyArg, class ValueArg>
+    Slot attach(const Place& place, KeyArg&& key, ValueArg&& value);
+    // Take a node out of the tree. Its slot still has to be released.
+    void unlink(Slot slot);
 
 public:
-    Node<T, K, NodeType>* _get(const K& key) const;
+    T* _get(const K& key);
+    const T* _get(const K& key) const;
 
     bool _insert(const K&& key, const T&& value);
 
+    bool _set(const K& key, const T&& value);
+
     bool _remove(const K& key);
 
+    NodeHandle<T, K> _extract(const K& key);
+
+    bool _insert(NodeHandle<T, K>&& node);
+
+    // Position of the node with @p key, empty if it doesn't exist.
+    Position position(const K& key) const {
+        return Position{find(key)};
+    }
+
+    // Hinted insert, see `Tree::insert_hint`.
+    // Climbs from @p hint by parent links until its subtree must hold @p key, then descends.
+    // O(log n), cheaper than from the root when @p key falls below a low ancestor of @p hint.
+    // There are no level links, so even a key two places from @p hint may climb to the root.
+    Position _insert_hint(Position hint, const K&& key, const T&& value);
+
+    template<size_t OtherSize, template<class, class, size_t> class OtherStorage, class OtherAugment, size_t OtherCacheSize>
+    size_t _merge(AVLTree<T, K, OtherSize, OtherStorage, OtherAugment, OtherCacheSize>& other);
+
     size_t _size() const {
         return count;
     }
 
     void _clear();
+
+    // Aggregate of the values with keys in `[lo, hi)`.
+    // Only available with `Aggregate<Monoid>` augmentation.
+    template<class A = Augment>
+    typename A::Type _aggregate(const K& lo, const K& hi) const;
+
+    // Compares keys and values in key order, not shapes.
+    // O(n), with `MerkleHash` trees that differ in count or hash are told apart in O(1).
+    bool _equals(const AVLTree& other) const {
+        return equals(other, std::is_same<Augment, MerkleHash>{});
+    }
+
+    // Hash-only equality, only available with `MerkleHash` augmentation.
+    // O(1). False means the contents differ, true only that they're equal or their hashes collide.
+    bool probably_equal(const AVLTree& other) const {
+        static_assert(std::is_same<Augment, MerkleHash>::value, "probably_equal needs MerkleHash augmentation");
+        return count == other.count
+            && (root == NoSlot || node(root).aggregate == other.node(other.root).aggregate);
+    }
+
+    // Visit the differences with @p other.
+    // Only available with `MerkleHash` augmentation.
+    // Calls `fn(const K& key, const T* value, const T* otherValue)` in key order for every key
+    // missing from one of the trees (its value is `nullptr`) or with different values.
+    // Ranges with equal hashes are skipped, so it's about O(d log^2 n) for d differences
+    // (a hash collision would hide the differences of its range).
+    /// @note Don't change either tree from @p fn.
+    template<class Fn>
+    void _diff(const AVLTree& other, Fn&& fn) const;
+
+    // Lookup cache statistics, always 0 without a cache.
+    size_t cache_hits() const {
+        return cache.hits();
+    }
+    size_t cache_misses() const {
+        return cache.misses();
+    }
+    void reset_cache_stats() {
+        cache.reset_stats();
+    }
 };
 
+
+// Member templates on the caller's types (`_diff`'s callback, `_aggregate`'s augmentation)
+// and the helpers they need are defined here, so user code can instantiate them.
+
+template <class T, class K, size_t Size, template<class, class, size_t> class Storage, class Augment, size_t CacheSize>
+template <class A>
+typename A::Type AVLTree<T, K, Size, Storage, Augment, CacheSize>::_aggregate(const K& lo, const K& hi) const {
+    return aggregateRange<A>(&lo, &hi);
+}
+
+template <class T, class K, size_t Size, template<class, class, size_t> class Storage, class Augment, size_t CacheSize>
+template <class A>
+typename A::Type AVLTree<T, K, Size, Storage, Augment, CacheSize>::aggregateRange(const K* lo, const K* hi) const {
+    auto belowLo = [lo](const K& key) {
+        return lo != nullptr && key < *lo;
+    };
+    auto belowHi = [hi](const K& key) {
+        return hi == nullptr || key < *hi;
+    };
+
+    // First, find the topmost node in range, where paths to `lo` and `hi` split
+    auto split = root;
+    while (split != NoSlot) {
+        const auto& n = node(split);
+        if (belowLo(n.key))
+            split = n.right;
+        else if (!belowHi(n.key))
+            split = n.left;
+        else
+            break;
+    }
+
+    if (split == NoSlot)
+        return A::identity();
+
+    // Second, walk down to `lo`, taking in-range right subtrees whole
+    auto left = A::identity();
+    for (auto current = node(split).left; current != NoSlot;) {
+        const auto& n = node(current);
+        if (belowLo(n.key)) {
+            current = n.right;
+        } else {
+            auto part = A::lift(n.key, nodes.value(current));
+            if (n.right != NoSlot)
+                part = A::combine(part, node(n.right).aggregate);
+            left = A::combine(part, left);
+            current = n.left;
+        }
+    }
+
+    // Third, walk down to `hi`, taking in-range left subtrees whole
+    auto right = A::identity();
+    for (auto current = node(split).right; current != NoSlot;) {
+        const auto& n = node(current);
+        if (!belowHi(n.key)) {
+            current = n.left;
+        } else {
+            if (n.left != NoSlot)
+                right = A::combine(right, node(n.left).aggregate);
+            right = A::combine(right, A::lift(n.key, nodes.value(current)));
+            current = n.right;
+        }
+    }
+
+    return A::combine(A::combine(left, A::lift(node(split).key, nodes.value(split))), right);
+}
+
+
+template <class T, class K, size_t Size, template<class, class, size_t> class Storage, class Augment, size_t CacheSize>
+size_t AVLTree<T, K, Size, Storage, Augment, CacheSize>::rank(const K* key) const {
+    if (key == nullptr)
+        return 0;
+
+    size_t below = 0;
+    for (auto current = root; current != NoSlot;) {
+        const auto& n = node(current);
+        if (n.key < *key) {
+            below += subtreeCount(n.left) + 1;
+            current = n.right;
+        } else {
+            current = n.left;
+        }
+    }
+    return below;
+}
+
+template <class T, class K, size_t Size, template<class, class, size_t> class Storage, class Augment, size_t CacheSize>
+Slot AVLTree<T, K, Size, Storage, Augment, CacheSize>::select(size_t rank) const {
+    auto current = root;
+    while (current != NoSlot) {
+        const auto& n = node(current);
+        auto left = subtreeCount(n.left);
+        if (rank < left) {
+            current = n.left;
+        } else if (rank == left) {
+            return current;
+        } else {
+            rank -= left + 1;
+            current = n.right;
+        }
+    }
+    return NoSlot;
+}
+
+
+template <class T, class K, size_t Size, template<class, class, size_t> class Storage, class Augment, size_t CacheSize>
+template <class Fn>
+void AVLTree<T, K, Size, Storage, Augment, CacheSize>::_diff(const AVLTree& other, Fn&& fn) const {
+    static_assert(std::is_same<Augment, MerkleHash>::value, "diff needs MerkleHash augmentation");
+
+    // Key range `[*lo, *hi)`, `nullptr` bounds are open
+    struct Range {
+        const K* lo;
+        const K* hi;
+    };
+
+    // Left halves are taken first, the stack only holds right halves along one path.
+    // Each split at least halves the bigger side.
+    std::array<Range, 2 * sizeof(size_t) * 8> stack;
+    size_t stackSize = 0;
+    stack[stackSize++] = Range{nullptr, nullptr};
+
+    while (stackSize > 0) {
+        auto range = stack[--stackSize];
+
+        auto mine = aggregateRange<MerkleHash>(range.lo, range.hi);
+        auto theirs = other.template aggregateRange<MerkleHash>(range.lo, range.hi);
+        if (mine == theirs)
+            continue;
+
+        if (mine.count <= 1 && theirs.count <= 1) {
+            // At most one key on each side, compare them directly
+            auto a = mine.count == 0 ? NoSlot : select(rank(range.lo));
+            auto b = theirs.count == 0 ? NoSlot : other.select(other.rank(range.lo));
+
+            if (a != NoSlot && b != NoSlot && node(a).key == other.node(b).key) {
+                fn(node(a).key, &nodes.value(a), &other.nodes.value(b));
+            } else if (b == NoSlot || (a != NoSlot && node(a).key < other.node(b).key)) {
+                fn(node(a).key, &nodes.value(a), static_cast<const T*>(nullptr));
+                if (b != NoSlot)
+                    fn(other.node(b).key, static_cast<const T*>(nullptr), &other.nodes.value(b));
+            } else {
+                fn(other.node(b).key, static_cast<const T*>(nullptr), &other.nodes.value(b));
+                if (a != NoSlot)
+                    fn(node(a).key, &nodes.value(a), static_cast<const T*>(nullptr));
+            }
+            continue;
+        }
+
+        // Split at the middle key of the bigger side
+        const K* middle;
+        if (mine.count >= theirs.count)
+            middle = &node(select(rank(range.lo) + mine.count / 2)).key;
+        else
+            middle = &other.node(other.select(other.rank(range.lo) + theirs.count / 2)).key;
+
+        stack[stackSize++] = Range{middle, range.hi};
+        stack[stackSize++] = Range{range.lo, middle};
+    }
+}
+
 }  // namespace Tree
 
 #endif // TREE_AVL_H
@@ -0,0 +1,121 @@
+#ifndef TREE_AUGMENT_H
+#define TREE_AUGMENT_H
+
+#include <limits>
+
+
+namespace Tree {
+
+// Augmentation interface
+//
+// An augmentation keeps some data about the whole subtree in every node,
+// e.g. the max endpoint of an interval tree.
+// Trees recompute it bottom-up whenever a node's children or value change
+// (insert, remove, set and every rotation).
+//
+// Implementations must provide the following:
+// - `Data`, a struct the tree's hot node inherits from.
+//   An empty `Data` doesn't change the node size.
+// - `template<class NodeType, class T> static void update(NodeType& node, const T& value, const NodeType* left, const NodeType* right)`
+//   Recomputes `node`'s data from its own key and value and its children's data.
+//   `left` and `right` are `nullptr` if the child doesn't exist.
+//
+// Trees with a non-empty `Data` only hand out const references to values
+// (`get` and `operator[]`), their values have to be changed with `set`.
+
+
+// No augmentation, the default.
+struct NoAugment {
+    struct Data {};
+
+    template<class NodeType, class T>
+    static void update(NodeType&, const T&, const NodeType*, const NodeType*) {}
+};
+
+
+// Monoid interface
+//
+// Monoids must provide the following:
+// - `Type`, the aggregated type.
+// - `static Type identity()`
+// - `template<class K, class T> static Type lift(const K& key, const T& value)`
+// - `static Type combine(const Type& a, const Type& b)`, associative,
+//   `identity()` is neutral. Doesn't have to be commutative,
+//   `a` always comes before `b` in key order.
+
+
+// Keeps the monoid aggregate of the subtree in every node.
+// Enables `Tree::aggregate(lo, hi)` in O(log n).
+template<class Monoid>
+struct Aggregate : Monoid {
+    using Type = typename Monoid::Type;
+
+    struct Data {
+        Type aggregate{};
+    };
+
+    template<class NodeType, class T>
+    static void update(NodeType& node, const T& value, const NodeType* left, const NodeType* right) {
+        node.aggregate = Monoid::lift(node.key, value);
+        if (left != nullptr)
+            node.aggregate = Monoid::combine(left->aggregate, node.aggregate);
+        if (right != nullptr)
+            node.aggregate = Monoid::combine(node.aggregate, right->aggregate);
+    }
+};
+
+
+// Sum of values.
+template<class V>
+struct SumMonoid {
+    using Type = V;
+
+    static Type identity() {
+        return Type{};
+    }
+    template<class K, class T>
+    static Type lift(const K&, const T& value) {
+        return value;
+    }
+    static Type combine(const Type& a, const Type& b) {
+        return a + b;
+    }
+};
+
+// Smallest value.
+template<class V>
+struct MinMonoid {
+    using Type = V;
+
+    static Type identity() {
+        return std::numeric_limits<Type>::max();
+    }
+    template<class K, class T>
+    static Type lift(const K&, const T& value) {
+        return value;
+    }
+    static Type combine(const Type& a, const Type& b) {
+        return b < a ? b : a;
+    }
+};
+
+// Biggest value.
+template<class V>
+struct MaxMonoid {
+    using Type = V;
+
+    static Type identity() {
+        return std::numeric_limits<Type>::lowest();
+    }
+    template<class K, class T>
+    static Type lift(const K&, const T& value) {
+        return value;
+    }
+    static Type combine(const Type& a, const Type& b) {
+        return a < b ? b : a;
+    }
+};
+
+}  // namespace Tree
+
+#endif // TREE_AUGMENT_H
@@ -0,0 +1,97 @@
+#ifndef TREE_CACHE_H
+#define TREE_CACHE_H
+
+#include "trees/generic/storage.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+
+
+namespace Tree {
+
+// Hot key lookup cache
+//
+// Direct-mapped cache of `Entries` slots, indexed by the hash of the key.
+// Checked before descending the tree, so a hit costs one cache line here
+// and one for the node (to confirm the key).
+// Trees fill it on lookups and forget a key when its node leaves the tree,
+// slots never hold a stale node.
+// `K` needs a `std::hash`. `Entries` has to be a power of two, 0 disables the cache.
+template<class K, size_t Entries>
+class LookupCache {
+    static_assert(Entries != 0 && (Entries & (Entries - 1)) == 0, "Entries has to be a power of two");
+
+    std::array<Slot, Entries> slots;
+
+    size_t hitCount = 0;
+    size_t missCount = 0;
+
+    static size_t index(const K& key) {
+        // Fibonacci hashing, spreads sequential keys and weak hashes (identity for integers)
+        auto hash = static_cast<uint64_t>(std::hash<K>{}(key)) * 0x9e3779b97f4a7c15ull;
+        return static_cast<size_t>(hash >> 32) & (Entries - 1);
+    }
+
+public:
+
+    // Constructors
+    LookupCache() {
+        slots.fill(NoSlot);
+    }
+
+    // Slot cached for `key`'s entry. May belong to another key, the tree has to check.
+    Slot& entry(const K& key) {
+        return slots[index(key)];
+    }
+
+    void hit() {
+        hitCount++;
+    }
+    void miss() {
+        missCount++;
+    }
+
+    // Forget `key` if it's cached at `slot`.
+    void forget(const K& key, Slot slot) {
+        auto& cached = entry(key);
+        if (cached == slot)
+            cached = NoSlot;
+    }
+
+    void clear() {
+        slots.fill(NoSlot);
+    }
+
+    size_t hits() const {
+        return hitCount;
+    }
+    size_t misses() const {
+        return missCount;
+    }
+    void reset_stats() {
+        hitCount = 0;
+        missCount = 0;
+    }
+};
+
+// No cache
+template<class K>
+class LookupCache<K, 0> {
+public:
+    void forget(const K&, Slot) {}
+    void clear() {}
+
+    size_t hits() const {
+        return 0;
+    }
+    size_t misses() const {
+        return 0;
+    }
+    void reset_stats() {}
+};
+
+}  // namespace Tree
+
+#endif // TREE_CACHE_H
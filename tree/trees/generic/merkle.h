@@ -0,0 +1,95 @@
+#ifndef TREE_MERKLE_H
+#define TREE_MERKLE_H
+
+#include "trees/generic/augment.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+
+
+namespace Tree {
+
+// Order-based hash of a sequence of key/value pairs.
+//
+// Polynomial hash modulo the Mersenne prime 2^61 - 1:
+// hash(e1 .. en) = e1 * B^(n-1) + ... + en, for entry hashes e.
+// Combining two sequences only needs their hashes and B^length,
+// so the hash of a subtree doesn't depend on its shape, only on its contents in key order.
+// Two trees with the same contents get the same root hash however they were built.
+//
+// `K` and `T` need a `std::hash`.
+struct MerkleMonoid {
+    struct Type {
+        uint64_t hash = 0;
+        // B^count
+        uint64_t power = 1;
+        size_t count = 0;
+
+        bool operator==(const Type& other) const {
+            return hash == other.hash && power == other.power && count == other.count;
+        }
+        bool operator!=(const Type& other) const {
+            return !(*this == other);
+        }
+    };
+
+    static constexpr uint64_t Modulus = (uint64_t(1) << 61) - 1;
+    static constexpr uint64_t Base = 0x1d8e4e27c47d124full;
+
+    static Type identity() {
+        return Type{};
+    }
+
+    template<class K, class T>
+    static Type lift(const K& key, const T& value) {
+        auto hash = mix(mix(std::hash<K>{}(key)) ^ std::hash<T>{}(value));
+        return Type{reduce(hash), Base, 1};
+    }
+
+    static Type combine(const Type& a, const Type& b) {
+        return Type{
+            reduce(multiply(a.hash, b.power) + b.hash),
+            multiply(a.power, b.power),
+            a.count + b.count};
+    }
+
+private:
+    // splitmix64 finalizer, `std::hash` of integers is the identity
+    static uint64_t mix(uint64_t x) {
+        x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ull;
+        x = (x ^ (x >> 27)) * 0x94d049bb133111ebull;
+        return x ^ (x >> 31);
+    }
+
+    // x mod 2^61 - 1, for x < 2^64
+    static uint64_t reduce(uint64_t x) {
+        x = (x & Modulus) + (x >> 61);
+        return x >= Modulus ? x - Modulus : x;
+    }
+
+    // a * b mod 2^61 - 1, for a, b < 2^61, without 128-bit integers
+    static uint64_t multiply(uint64_t a, uint64_t b) {
+        const uint64_t low32 = 0xffffffffull;
+        const uint64_t low29 = (uint64_t(1) << 29) - 1;
+
+        uint64_t aHigh = a >> 32, aLow = a & low32;
+        uint64_t bHigh = b >> 32, bLow = b & low32;
+
+        // 2^64 = 8 and 2^61 = 1 (mod 2^61 - 1)
+        uint64_t middle = aHigh * bLow + aLow * bHigh;
+        uint64_t result = (aHigh * bHigh << 3)
+            + (middle >> 29) + ((middle & low29) << 32)
+            + reduce(aLow * bLow);
+        return reduce(result);
+    }
+};
+
+// Keeps the order-based hash of its subtree in every node.
+// `Tree::operator==` tells different trees apart in O(1) (it still walks equal ones),
+// enables `Tree::diff` and `AVLTree::probably_equal`.
+using MerkleHash = Aggregate<MerkleMonoid>;
+
+}  // namespace Tree
+
+#endif // TREE_MERKLE_H
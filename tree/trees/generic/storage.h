@@ -0,0 +1,96 @@
+#ifndef TREE_STORAGE_H
+#define TREE_STORAGE_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+
+namespace Tree {
+
+// Index of a node in a tree's storage.
+// Trees link nodes by slot instead of by pointer,
+// so the storage layout can change without touching the balancing code.
+using Slot = uint32_t;
+
+// Slot that doesn't point to any node (the `nullptr` of slots).
+constexpr Slot NoSlot = std::numeric_limits<Slot>::max();
+
+
+// Storage interface
+//
+// A storage holds `Size` node slots. Each slot has a "hot" part `Hot`
+// (key, links and balance info, defined by the tree) and a value `T`.
+// Trees only touch `hot()` while descending and rebalancing,
+// `value()` is touched only on a hit.
+//
+// Implementations must provide the following functions:
+// - Default constructor. Doesn't use dynamic memory allocation (uses std::array).
+// - `Hot& hot(Slot slot)`
+// - `const Hot& hot(Slot slot) const`
+// - `T& value(Slot slot)`
+// - `const T& value(Slot slot) const`
+
+
+// Array of structures.
+// The hot part and the value of a slot are stored next to each other.
+// Good for small values: a hit doesn't need another cache line.
+template <class Hot, class T, size_t Size>
+class PackedStorage {
+    static_assert(Size < NoSlot, "Size doesn't fit in a Slot");
+
+    struct Entry {
+        Hot hot{};
+        T value{};
+    };
+
+    std::array<Entry, Size> entries{};
+
+public:
+    Hot& hot(Slot slot) {
+        return entries[slot].hot;
+    }
+    const Hot& hot(Slot slot) const {
+        return entries[slot].hot;
+    }
+
+    T& value(Slot slot) {
+        return entries[slot].value;
+    }
+    const T& value(Slot slot) const {
+        return entries[slot].value;
+    }
+};
+
+
+// Structure of arrays.
+// Hot parts live in one dense array, values in a parallel array indexed by slot.
+// Good for big values: a descent step only touches keys and links,
+// several hot parts share a cache line.
+template <class Hot, class T, size_t Size>
+class SplitStorage {
+    static_assert(Size < NoSlot, "Size doesn't fit in a Slot");
+
+    std::array<Hot, Size> hots{};
+    std::array<T, Size> values{};
+
+public:
+    Hot& hot(Slot slot) {
+        return hots[slot];
+    }
+    const Hot& hot(Slot slot) const {
+        return hots[slot];
+    }
+
+    T& value(Slot slot) {
+        return values[slot];
+    }
+    const T& value(Slot slot) const {
+        return values[slot];
+    }
+};
+
+}  // namespace Tree
+
+#endif // TREE_STORAGE_H
@@ -0,0 +1,118 @@
+#ifndef TREE_INTERVAL_H
+#define TREE_INTERVAL_H
+
+#include "trees/avl.h"
+
+#include <array>
+#include <cstddef>
+#include <functional>
+
+
+namespace Tree {
+
+// Closed interval `[lo, hi]`, the key of an `IntervalTree`.
+// Ordered by `lo`, then by `hi`.
+// `B` has to be comparable (`operator<`).
+template<class B>
+struct Interval {
+    B lo{};
+    B hi{};
+
+    bool operator<(const Interval& other) const {
+        return lo < other.lo || (!(other.lo < lo) && hi < other.hi);
+    }
+    bool operator==(const Interval& other) const {
+        return !(*this < other) && !(other < *this);
+    }
+};
+
+
+// Keeps the max endpoint (`hi`) of the subtree in every node.
+template<class B>
+struct IntervalAugment {
+    struct Data {
+        B maxHi{};
+    };
+
+    template<class NodeType, class T>
+    static void update(NodeType& node, const T&, const NodeType* left, const NodeType* right) {
+        node.maxHi = node.key.hi;
+        if (left != nullptr && node.maxHi < left->maxHi)
+            node.maxHi = left->maxHi;
+        if (right != nullptr && node.maxHi < right->maxHi)
+            node.maxHi = right->maxHi;
+    }
+};
+
+
+// AVL tree of intervals with overlap and stabbing queries.
+// Keys are `Interval<B>`, the same interval can only be inserted once.
+// Queries visit the root paths of the k results, O(k log(n / k) + log n),
+// and don't allocate.
+template<class T, class B, size_t Size,
+    template<class, class, size_t> class Storage = PackedStorage>
+class IntervalTree : public AVLTree<T, Interval<B>, Size, Storage, IntervalAugment<B>> {
+public:
+    using KeyType = Interval<B>;
+
+    // Overlap query
+    // Calls `fn(const Interval<B>& interval, const T& value)` for every interval
+    // intersecting `[lo, hi]`, in key order.
+    // Defined here rather than in a .cpp, it's instantiated with the caller's `Fn`.
+    template<class Fn>
+    void find_overlapping(const B& lo, const B& hi, Fn&& fn) const {
+        // In-order walk with an explicit stack (no recursion, no allocation)
+        std::array<Slot, IntervalTree::MaxHeight> stack;
+        size_t stackSize = 0;
+
+        auto current = this->root;
+        while (true) {
+            // Go left, skipping subtrees that end before `lo`
+            while (current != NoSlot && !(this->node(current).maxHi < lo)) {
+                stack[stackSize++] = current;
+                current = this->node(current).left;
+            }
+
+            if (stackSize == 0)
+                return;
+
+            current = stack[--stackSize];
+            const auto& n = this->node(current);
+
+            // This node and everything after it starts after `hi`
+            if (hi < n.key.lo)
+                return;
+
+            if (!(n.key.hi < lo))
+                fn(n.key, this->nodes.value(current));
+
+            current = n.right;
+        }
+    }
+
+    // Stabbing query
+    // Calls `fn(const Interval<B>& interval, const T& value)` for every interval
+    // containing `point`, in key order.
+    template<class Fn>
+    void stab(const B& point, Fn&& fn) const {
+        find_overlapping(point, point, fn);
+    }
+};
+
+}  // namespace Tree
+
+
+namespace std {
+
+// Hash of intervals, for trace keys.
+template<class B>
+struct hash<Tree::Interval<B>> {
+    size_t operator()(const Tree::Interval<B>& interval) const {
+        auto lo = hash<B>{}(interval.lo);
+        return lo ^ (hash<B>{}(interval.hi) + 0x9e3779b97f4a7c15ull + (lo << 6) + (lo >> 2));
+    }
+};
+
+}  // namespace std
+
+#endif // TREE_INTERVAL_H
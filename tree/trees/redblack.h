@@ -2,6 +2,8 @@
 #define TREE_REDBLACK_H
 
 #include "tree.h"
+#include "trees/generic/augment.h"
+#include "trees/generic/storage.h"
 
 #include <array>
 #include <bitset>
@@ -9,62 +11,48 @@
 
 namespace Tree {
 
-// Implementations should inherit from `Node` class.
-// They must implement the following functions:
-// - Default constructor. `Tree`s may allocate `std::array`s of nodes on creation.
-// - Move assignment operators.
-// - Equality operator. Only compares the node's key and value.
-// - `K& _key()`
-// - `const K& _key() const`
-// - `T& _value()`
-// - `const T& _value() const`
-
-template<class T, class K>
-class RedBlackNode : public Node<T, K, RedBlackNode<T, K>> {
-    using NodeType = RedBlackNode;
-
+// Hot part of a red-black node: everything a descent or a rotation touches.
+// The value lives in the tree's storage, next to it or in a separate array.
+// `Data` is the augmentation data, see `trees/generic/augment.h`.
+template<class K, class Data = NoAugment::Data>
+struct RedBlackNode : Data {
     K key{};
-    T value{};
 
-    Node<T, K, NodeType>* left = nullptr;
-    Node<T, K, NodeType>* right = nullptr;
+    Slot parent = NoSlot;
+    Slot left = NoSlot;
+    Slot right = NoSlot;
 
     // First bit (LSB) is red (1) or black (0)
     // Second bit is exist (1) or not (0)
     std::bitset<2> bits{};
-
-public:
-
-    // Constructors
-    RedBlackNode() = default;
-    RedBlackNode(const K&& key, const T&& value, bool red = true) : key(key), value(value) {
-        bits[0] = red;
-        bits[1] = true;
-    }
-
-    bool operator==(const NodeType& other) const {
-        return key == other.key && value == other.value;
-    }
-
-    // Assignment operators
-    NodeType& operator=(NodeType&& other) = default;
 };
 
 
  // Implementations should inherit from `Tree` class.
 // They must implement the following functions:
 // - Copy and move assignment operators.
-// - `Node<T, K, NodeType>* _get(const K& key) const`
+// - `T* _get(const K& key)`
+// - `const T* _get(const K& key) const`
 // - `bool _insert(const K&& key, const T&& value)`
+// - `bool _set(const K& key, const T&& value)`
 // - `bool _remove(const K& key)`
 // - `size_t _size() const`
 // - `void _clear()`
-
-template<class T, class K, size_t Size>
-class RedBlackTree : public Tree<T, K, Size, RedBlackTree<T, K, Size>> {
+// - `AugmentType`
+//
+// `Storage` is the layout of the node pool, see `trees/generic/storage.h`.
+// `Augment` is kept up to date in every node, see `trees/generic/augment.h`.
+// With `Aggregate<Monoid>` the tree also implements `_aggregate(lo, hi)`.
+
+template<class T, class K, size_t Size,
+    template<class, class, size_t> class Storage = PackedStorage,
+    class Augment = NoAugment>
+class RedBlackTree : public Tree<T, K, Size, RedBlackTree<T, K, Size, Storage, Augment>> {
 public:
     using TreeType = RedBlackTree;
-    using NodeType = RedBlackNode<T, K>;
+    using NodeType = RedBlackNode<K, typename Augment::Data>;
+    using StorageType = Storage<NodeType, T, Size>;
+    using AugmentType = Augment;
 
     // Constructors
     RedBlackTree() = default;
@@ -79,25 +67,28 @@ public:
     ~RedBlackTree() = default;
 
 private:
-    // The array of nodes.
-    std::array<Node<T, K, NodeType>, Size> nodes{};
+    // The pool of nodes.
+    StorageType nodes{};
     // Root node of the tree.
-    Node<T, K, NodeType>* root = nullptr;
+    Slot root = NoSlot;
     // Count of nodes in the tree.
     size_t count = 0;
 
 
     // RedBlack balancing functions
-    void rotateLeft(Node<T, K, NodeType>* node);
-    void rotateRight(Node<T, K, NodeType>* node);
-    void balance(Node<T, K, NodeType>* node);
-    void fixDoubleBlack(Node<T, K, NodeType>* node);
+    void rotateLeft(Slot slot);
+    void rotateRight(Slot slot);
+    void balance(Slot slot);
+    void fixDoubleBlack(Slot slot);
 
 protected:
-    Node<T, K, NodeType>* _get(const K& key) const;
+    T* _get(const K& key);
+    const T* _get(const K& key) const;
 
     bool _insert(const K&& key, const T&& value);
 
+    bool _set(const K& key, const T&& value);
+
     bool _remove(const K& key);
 
     size_t _size() const {
@@ -105,6 +96,11 @@ protected:
     }
 
     void _clear();
+
+    // Aggregate of the values with keys in `[lo, hi)`.
+    // Only available with `Aggregate<Monoid>` augmentation.
+    template<class A = Augment>
+    typename A::Type _aggregate(const K& lo, const K& hi) const;
 };
 
 }  // namespace Tree
@@ -0,0 +1,212 @@
+#ifndef TREE_STATIC_H
+#define TREE_STATIC_H
+
+#include <cstddef>
+#include <stdexcept>
+
+
+namespace Tree {
+
+// Key and value pair to build a `StaticTree` from.
+template<class T, class K>
+struct StaticEntry {
+    K key;
+    T value;
+};
+
+
+// Read-only lookup tree, built once from a list of entries.
+// Built at compile time when declared `constexpr`: no startup cost,
+// and the tree lands in read-only memory shared between processes.
+//
+// The tree is balanced and implicit: nodes are laid out in breadth-first
+// (Eytzinger) order, children of node `i` are `2i` and `2i + 1` (1-based),
+// so there are no links to store. Keys and values live in separate arrays,
+// a lookup only touches keys until it hits.
+//
+// Everything here is `constexpr`, unlike `Tree`'s interface it's usable in constant expressions.
+// `K` has to be comparable (`operator<`). For compile time construction
+// `K` and `T` have to be literal types (integers, enums, `const char*` values...).
+// Unlike `Tree`, this is not a CRTP implementation: there's nothing to insert or remove.
+template<class T, class K, size_t Size>
+class StaticTree {
+    static_assert(Size > 0, "StaticTree can't be empty");
+
+    // Index 0 is node 1
+    K keys[Size]{};
+    T values[Size]{};
+
+    // Node (1-based) of the smallest key
+    static constexpr size_t first() {
+        size_t node = 1;
+        while (node * 2 <= Size)
+            node *= 2;
+        return node;
+    }
+
+    // Node (1-based) after `node` in key order, 0 after the last one
+    static constexpr size_t next(size_t node) {
+        if (node * 2 + 1 <= Size) {
+            // Smallest node of the right subtree
+            node = node * 2 + 1;
+            while (node * 2 <= Size)
+                node *= 2;
+        } else {
+            // First ancestor this subtree is on the left of
+            while (node & 1)
+                node >>= 1;
+            node >>= 1;
+        }
+        return node;
+    }
+
+    // Node (1-based) with `key`, 0 if there's none
+    constexpr size_t find(const K& key) const {
+        size_t node = 1;
+        while (node <= Size) {
+            const auto& current = keys[node - 1];
+            if (key < current)
+                node = node * 2;
+            else if (current < key)
+                node = node * 2 + 1;
+            else
+                return node;
+        }
+        return 0;
+    }
+
+public:
+    using ValueType = T;
+    using KeyType = K;
+    using EntryType = StaticEntry<T, K>;
+
+    // Iterator in key order.
+    class Iterator {
+        const StaticTree* tree;
+        size_t node;
+
+    public:
+        constexpr Iterator(const StaticTree* tree, size_t node) : tree(tree), node(node) {}
+
+        constexpr const K& key() const {
+            return tree->keys[node - 1];
+        }
+        constexpr const T& value() const {
+            return tree->values[node - 1];
+        }
+
+        constexpr Iterator& operator++() {
+            node = StaticTree::next(node);
+            return *this;
+        }
+        // Dereferencing gives the iterator itself, use `key()` and `value()`.
+        constexpr const Iterator& operator*() const {
+            return *this;
+        }
+
+        constexpr bool operator==(const Iterator& other) const {
+            return node == other.node;
+        }
+        constexpr bool operator!=(const Iterator& other) const {
+            return node != other.node;
+        }
+    };
+
+    // Constructors
+    /// @throws std::invalid_argument if a key is there twice
+    ///   (a compile error when built at compile time).
+    constexpr StaticTree(const EntryType (&entries)[Size]) {
+        // First, sort the entries by key (insertion sort of indices, it runs once)
+        size_t order[Size]{};
+        for (size_t i = 0; i < Size; i++) {
+            size_t j = i;
+            while (j > 0 && entries[i].key < entries[order[j - 1]].key) {
+                order[j] = order[j - 1];
+                j--;
+            }
+            order[j] = i;
+        }
+
+        for (size_t i = 1; i < Size; i++)
+            if (!(entries[order[i - 1]].key < entries[order[i]].key))
+                throw std::invalid_argument("Key already exists");
+
+        // Second, lay them out walking the implicit tree in key order
+        size_t node = first();
+        for (size_t i = 0; i < Size; i++, node = next(node)) {
+            keys[node - 1] = entries[order[i]].key;
+            values[node - 1] = entries[order[i]].value;
+        }
+    }
+
+    // Index operator
+    /// @throws std::out_of_range if key doesn't exist
+    constexpr const T& operator[](const K& key) const {
+        return get(key);
+    }
+
+
+    constexpr size_t capacity() const {
+        return Size;
+    }
+    constexpr size_t size() const {
+        return Size;
+    }
+
+    constexpr bool is_empty() const {
+        return false;
+    }
+    constexpr bool is_full() const {
+        return true;
+    }
+
+
+    // Contains
+    /*[[nodiscard]]*/ constexpr bool contains_key(const K& key) const {
+        return find(key) != 0;
+    }
+
+    // Get
+    /// @throws std::out_of_range if key doesn't exist
+    /*[[nodiscard]]*/ constexpr const T& get(const K& key) const {
+        auto node = find(key);
+
+        if (node == 0)
+            throw std::out_of_range("Key doesn't exist in tree");
+
+        return values[node - 1];
+    }
+
+    // Try get
+    /// @p result is set to the value of the key if it exists.
+    /// @returns true if the key exists in the tree, false otherwise.
+    /*[[nodiscard]]*/ constexpr bool try_get(const K& key, T& result) const {
+        auto node = find(key);
+
+        if (node == 0)
+            return false;
+
+        result = values[node - 1];
+        return true;
+    }
+
+    // Iteration in key order
+    constexpr Iterator begin() const {
+        return Iterator(this, first());
+    }
+    constexpr Iterator end() const {
+        return Iterator(this, 0);
+    }
+};
+
+
+// Build a `StaticTree`, deducing its size.
+// `constexpr auto codes = Tree::make_static_tree<const char*, int>({{200, "OK"}, {404, "Not Found"}});`
+template<class T, class K, size_t Size>
+constexpr StaticTree<T, K, Size> make_static_tree(const StaticEntry<T, K> (&entries)[Size]) {
+    return StaticTree<T, K, Size>(entries);
+}
+
+}  // namespace Tree
+
+#endif // TREE_STATIC_H